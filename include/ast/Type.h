@@ -2,8 +2,11 @@
 #define TYPE_H_
 #include "ast.h"
 
+#include "common/hash-map.h"
 #include "context/context.h"
 
+#include <stdatomic.h>
+
 enum TypeKind {
   tk_BUILTIN,
   tk_ALIAS,
@@ -12,18 +15,43 @@ enum TypeKind {
   tk_POINTER,
 };
 
+enum BuiltinTypeKind {
+  btk_NONE,
+#define BUILTIN_TYPE(name, size, is_integer, is_signed) btk_##name,
+#include "definitions/builtin-types.def"
+};
+
 struct TypeField;
+struct ScopeSymbol;
 
+// types are unique, there is one pointer type per pointee and one symbol per
+// type, so types can be compared by pointer once aliases are resolved
 struct Type {
   enum TypeKind kind;
   char* name;
   struct Type* next;
   int size;
 
+  // valid for tk_BUILTIN, zero for everything else
+  enum BuiltinTypeKind builtin;
+  int is_integer;
+  int is_signed;
+
   // optional
   struct Type* alias_of;    // valid for tk_ALIAS
   struct TypeField* fields; // valid for tk_TYPEDEF
   struct Type* pointer_to;  // valid for tk_POINTER
+
+  // built by Type_freeze_fields, valid for tk_TYPEDEF
+  struct TypeField** field_array;
+  int num_fields;
+  struct HashMap fields_by_name;
+  int align;
+
+  // built on first use, possibly by several threads resolving scopes at once
+  _Atomic(struct Type*) ptr_type;
+  _Atomic(struct Type*) canonical;
+  _Atomic(struct ScopeSymbol*) symbol;
 };
 
 struct TypeField {
@@ -31,6 +59,8 @@ struct TypeField {
   struct Type* type;
   struct Type* parentType;
   struct TypeField* next;
+  int index;
+  int offset;
 };
 
 int Type_ptr_size();
@@ -38,11 +68,15 @@ struct Type* Type_int_type(struct Context* ctx, int size);
 
 struct Type* Type_void_type(struct Context* ctx);
 
+// the type with every alias resolved, including those in pointee types
+struct Type* Type_canonical(struct Type* t);
 int Type_eq(struct Type* t1, struct Type* t2);
 
 char* Type_to_string(struct Type* t);
 
 struct Type* Type_get_ptr_type(struct Type* t);
+// frees every pointer type built on `t`, e.g. `t*` and `t**`
+void Type_free_ptr_types(struct Type* t);
 // follow alias chains to base type
 struct Type* Type_get_base_type(struct Type* t);
 
@@ -60,9 +94,14 @@ int Type_is_boolean(struct Type* t);
 int Type_get_size(struct Type* t);
 
 int Type_is_typedef(struct Type* t);
+// called once all of a typedef's fields are added. indexes the fields and lays
+// them out with natural alignment, which is what the LLVM data layouts we
+// target use for every builtin type
+void Type_freeze_fields(struct Type* t);
+// frees the tables built by Type_freeze_fields
+void Type_free_fields(struct Type* t);
 struct TypeField* Type_get_TypeField(struct Type* t, char* name);
 int TypeField_get_index(struct TypeField* tf);
-// returns the offset in bits, assuming a PACKED struct
-// this does not take alignment or padding into account
+// returns the offset in bits, including any padding before the field
 int TypeField_get_offset(struct TypeField* tf);
 #endif
@@ -5,6 +5,10 @@
 #include "context/context.h"
 
 #include <stdlib.h>
+
+struct ScopeResult;
+struct Type;
+
 enum OperatorType {
   op_NONE = 0,
   op_PLUS,
@@ -47,22 +51,36 @@ enum AstType {
 };
 #define AST_MAX_CHILDREN 4
 
+struct AstNode_Number {
+  int64_t value;
+  int size;
+};
+
+// nodes are allocated with only as much of the union as their kind uses
 struct AstNode {
   enum AstType at;
-  struct AstNode* next;
-  struct AstNode* children[AST_MAX_CHILDREN];
+  // operator, pointer level, linkage or other small flag, by kind
   int int_value;
+  // number of arguments for calls and functions
   int int_value2;
-  char* str_value;
-  wchar_t* wstr_value;
-  void* node_information;
-};
-
-struct AstNode_Number {
-  int64_t value;
-  int size;
+  struct AstNode* next;
+  union {
+    struct AstNode* children[AST_MAX_CHILDREN];
+    char* str_value;
+    wchar_t* wstr_value;
+    struct AstNode_Number number;
+    // blocks keep their statements in children[0]
+    struct {
+      struct AstNode* stmts;
+      struct ScopeResult* scope;
+    } block;
+  };
 };
 
+// nodes built on the calling thread are allocated from `arena`, which owns
+// them and their strings. returns the previous arena. with no arena set nodes
+// are malloced and never freed
+struct Arena* ast_set_arena(struct Arena* arena);
 struct AstNode* ast_allocate(enum AstType at);
 struct AstNode* ast_next(struct AstNode* ast);
 void ast_append(struct AstNode** head, struct AstNode* tail);
@@ -70,6 +88,11 @@ enum AstType ast_type(struct AstNode* ast);
 int ast_is_type(struct AstNode* ast, enum AstType at);
 int ast_num_children(struct AstNode* ast);
 struct AstNode* ast_get_child(struct AstNode* ast, int);
+// the type scope resolution computed for an expression node, NULL until set.
+// only expression kinds have room for it, setting it on anything else is a
+// no-op
+struct Type* ast_resolved_type(struct AstNode* ast);
+void ast_set_resolved_type(struct AstNode* ast, struct Type* type);
 wchar_t* ast_to_string(struct AstNode* ast);
 
 void dump_ast(struct Context* context);
@@ -86,11 +109,13 @@ void verify_ast(struct Context* context);
         i++)
 
 /* Identifier */
+// names are stored as is and must already be interned, see common/intern.h
 struct AstNode* ast_build_Identifier(char* name);
 int ast_verify_Identifier(struct AstNode* ast);
 char* ast_Identifier_name(struct AstNode* ast);
 
 /* Typename */
+// names must already be interned, like identifiers
 struct AstNode* ast_build_Typename(char* name);
 struct AstNode* ast_build_Typename2(char* name, int ptr_level);
 int ast_verify_Typename(struct AstNode* ast);
@@ -177,6 +202,10 @@ struct AstNode* ast_build_Block(struct AstNode* stmts);
 struct AstNode* ast_build_EmptyBlock();
 int ast_verify_Block(struct AstNode* ast);
 struct AstNode* ast_Block_stmts(struct AstNode* ast);
+void ast_Block_set_stmts(struct AstNode* ast, struct AstNode* stmts);
+// the scope built for the block by scope resolution, if any
+struct ScopeResult* ast_Block_scope(struct AstNode* ast);
+void ast_Block_set_scope(struct AstNode* ast, struct ScopeResult* scope);
 int ast_Block_is_empty(struct AstNode* ast);
 
 /* Conditional */
@@ -227,6 +256,8 @@ int ast_Number_size(struct AstNode* ast);
 
 /* String */
 struct AstNode* ast_build_String(wchar_t* value);
+// value does not need to be nul terminated
+struct AstNode* ast_build_String2(wchar_t* value, int len);
 int ast_verify_String(struct AstNode*);
 wchar_t* ast_String_value(struct AstNode* ast);
 
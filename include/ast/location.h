@@ -9,8 +9,8 @@ struct Location {
   struct AstNode* ast;
   int line_start;
   int line_end;
-  struct Location* next;
 };
+// an ast keeps the first location added for it
 void Context_add_location(struct Context* context, struct Location* loc);
 struct Location* Context_build_location(
     struct Context* context,
@@ -2,6 +2,8 @@
 #include "Type.h"
 #include "ast.h"
 
+#include "common/hash-map.h"
+
 // scope resolve ast, building a ScopeResult object
 
 enum ScopeSymbolType { sst_Variable, sst_Function, sst_Type, sst_Builtin };
@@ -19,7 +21,13 @@ struct ScopeFunction {
   int num_args;
   struct ScopeSymbol** args;
 };
+// one per BUILTIN_FUNCTION, named after its codegen function
+enum CompilerBuiltinKind {
+#define BUILTIN_FUNCTION(name, numArgs, retType, codegenFunc) cb_##codegenFunc,
+#include "definitions/builtins.def"
+};
 struct CompilerBuiltin {
+  enum CompilerBuiltinKind kind;
   char* name;
   int num_args;
   struct Type* rettype;
@@ -27,6 +35,8 @@ struct CompilerBuiltin {
 struct ScopeSymbol {
   enum ScopeSymbolType sst;
   struct ScopeSymbol* next;
+  // position in the scope it was declared in
+  int order;
 
   struct ScopeVariable* ss_variable;
   struct ScopeFunction* ss_function;
@@ -44,15 +54,22 @@ int ScopeSymbol_isType(struct ScopeSymbol* sym);
 
 struct ScopeResult {
   struct AstNode* ast;
+  // in declaration order
   struct ScopeSymbol* symbols;
+  struct ScopeSymbol* symbols_tail;
+  int num_symbols;
+  // maps each interned name to the first symbol declared with it
+  struct HashMap symbols_by_name;
 
   struct ScopeResult* parent_scope;
-  struct ScopeResult* next;
 };
 
 void scope_resolve(struct Context* ctx);
+// frees what the scopes hold outside of the AST arena
+void scope_deinit(struct Context* ctx);
 struct ScopeResult* scope_lookup(struct Context* ctx, struct AstNode* ast);
 
+// lookups by name intern the name first, so any string can be passed
 struct ScopeSymbol* scope_lookup_name(
     struct Context* ctx,
     struct ScopeResult* sr,
@@ -1,9 +1,11 @@
 #ifndef IR_CODEGEN_LLVM_H_
 #define IR_CODEGEN_LLVM_H_
 
+#include "common/hash-map.h"
 #include "context/context.h"
 
 #include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
 
 struct DebugInfo {
   LLVMMetadataRef fileUnit;
@@ -19,11 +21,14 @@ struct di_function {
   struct di_scope* scope_stack;
 };
 
+// an r-value holds the value itself. an l-value holds the address of a
+// `cg_type` object, only named variables and fields are l-values
 struct cg_value {
   struct ScopeSymbol* variable;
   struct Type* type;
   LLVMValueRef value;
   LLVMTypeRef cg_type;
+  int is_lvalue;
   struct cg_value* next;
 };
 
@@ -42,13 +47,23 @@ struct cg_context {
   LLVMContextRef llvmContext;
   LLVMModuleRef module;
   LLVMBuilderRef builder;
+  // for the host, the module takes its triple and data layout from this
+  LLVMTargetMachineRef targetMachine;
 
   LLVMDIBuilderRef debugBuilder;
   struct DebugInfo di;
 
-  struct cg_value* current_values;
+  // the values of named variables, keyed by their Variable node. locals only
+  // live while their function is generated
+  struct HashMap global_values;
+  struct HashMap local_values;
+  // in definition order
   struct cg_function* functions;
-  struct cg_type* struct_types;
+  struct cg_function* functions_tail;
+  // maps each interned mangled name to the first function added with it
+  struct HashMap functions_by_name;
+  // canonical Type to its LLVMTypeRef, see get_llvm_type
+  struct HashMap llvm_types;
 };
 
 void init_cg_context(struct Context* context);
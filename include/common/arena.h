@@ -0,0 +1,21 @@
+#ifndef COMMON_ARENA_H_
+#define COMMON_ARENA_H_
+
+#include <stddef.h>
+
+// a simple bump allocator. memory is handed out from large blocks and is only
+// ever released all at once by Arena_deinit
+struct ArenaBlock;
+struct Arena {
+  struct ArenaBlock* blocks;
+  size_t next_block_size;
+};
+
+void Arena_init(struct Arena* arena, size_t initial_size);
+void Arena_deinit(struct Arena* arena);
+// returns zeroed memory, suitably aligned for any type
+void* Arena_allocate(struct Arena* arena, size_t size);
+// moves every block of `other` into `arena`, leaving `other` empty
+void Arena_adopt(struct Arena* arena, struct Arena* other);
+
+#endif
@@ -13,5 +13,8 @@ char* bsstrcat(const char* str1, const char* str2);
 wchar_t* peblwstrcat(const wchar_t* str1, const wchar_t* str2);
 
 long long wcs_to_int(wchar_t* wcs);
+// only converts the first len chars, which must all be digits. returns 0 if
+// the number does not fit in a long long
+int wcsn_to_int(wchar_t* wcs, int len, long long* value);
 
 #endif
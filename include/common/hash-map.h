@@ -0,0 +1,38 @@
+#ifndef COMMON_HASH_MAP_H_
+#define COMMON_HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// an open addressing hash map from keys to values. keys are either nul
+// terminated strings compared by content, or pointers compared by identity.
+// the map never copies or frees keys or values
+struct HashMapEntry {
+  const void* key;
+  uint64_t hash;
+  void* value;
+};
+struct HashMap {
+  struct HashMapEntry* entries;
+  size_t capacity;
+  size_t size;
+  int string_keys;
+};
+
+void HashMap_init_strings(struct HashMap* map);
+void HashMap_init_pointers(struct HashMap* map);
+void HashMap_deinit(struct HashMap* map);
+
+// returns NULL if there is no such key
+void* HashMap_get(struct HashMap* map, const void* key);
+// replaces any existing value for key
+void HashMap_put(struct HashMap* map, const void* key, void* value);
+// only adds key if it is not already in the map, returns the value kept
+void* HashMap_put_new(struct HashMap* map, const void* key, void* value);
+// adds every key of `other` that is not already in `map`
+void HashMap_merge(struct HashMap* map, struct HashMap* other);
+
+uint64_t hash_string(const char* s);
+uint64_t hash_bytes(const void* data, size_t len);
+
+#endif
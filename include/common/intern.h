@@ -0,0 +1,9 @@
+#ifndef COMMON_INTERN_H_
+#define COMMON_INTERN_H_
+
+// every distinct string is stored once for the whole process, so two interned
+// strings are equal exactly when their pointers are. interned strings must not
+// be modified and are never freed. safe to call from any thread
+char* intern(const char* str);
+
+#endif
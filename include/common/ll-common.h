@@ -23,6 +23,21 @@
     }                                                                          \
   } while(0)
 
+// appends in O(1) by keeping a pointer to the last node, `node` may be a list
+#define LL_APPEND_TAIL(head, tail, node)                                       \
+  do {                                                                         \
+    DECLTYPE(tail) node_ = (node);                                             \
+    if((head) == NULL) {                                                       \
+      (head) = node_;                                                          \
+    } else {                                                                   \
+      (tail)->next = node_;                                                    \
+    }                                                                          \
+    (tail) = node_;                                                            \
+    while((tail)->next != NULL) {                                              \
+      (tail) = (tail)->next;                                                   \
+    }                                                                          \
+  } while(0)
+
 #define LL_FOREACH(root, name)                                                 \
   for(DECLTYPE(root) name = (root); name != NULL; name = name->next)
 
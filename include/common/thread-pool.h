@@ -0,0 +1,19 @@
+#ifndef COMMON_THREAD_POOL_H_
+#define COMMON_THREAD_POOL_H_
+
+// a fixed set of worker threads that run submitted jobs in FIFO order
+struct ThreadPool;
+
+typedef void (*ThreadPoolJob)(void* arg);
+
+struct ThreadPool* ThreadPool_create(int num_threads);
+// waits for all submitted jobs before tearing down the workers
+void ThreadPool_destroy(struct ThreadPool* pool);
+void ThreadPool_submit(struct ThreadPool* pool, ThreadPoolJob job, void* arg);
+// blocks until every job submitted so far has finished
+void ThreadPool_wait(struct ThreadPool* pool);
+
+// number of cores available, used when the user asks for 0 threads
+int ThreadPool_hardware_threads(void);
+
+#endif
@@ -1,16 +1,45 @@
 #ifndef ARGUMENTS_H_
 #define ARGUMENTS_H_
+
+// what peblc writes to the output file
+enum EmitKind {
+  ek_LLVM_IR,
+  ek_BITCODE,
+  ek_ASSEMBLY,
+  ek_OBJECT,
+};
+
 struct Arguments {
   char* inFilename;
   char* outFilename;
   int isDebug;
+  // worker threads for the frontend, 1 keeps everything on the main thread
+  int numThreads;
+  // only parse the bodies of functions reachable from main or an export
+  int lazyBodies;
+  enum EmitKind emitKind;
+  // a new pass manager pipeline run before emitting, NULL runs nothing
+  char* passes;
+  int timePasses;
 };
 
 struct Arguments*
 create_Arguments(char* inFilename, char* outFilename, int isDebug);
+void destroy_Arguments(struct Arguments* args);
 
 char* Arguments_inFilename(struct Arguments* args);
 char* Arguments_outFilename(struct Arguments* args);
 int Arguments_isDebug(struct Arguments* args);
+int Arguments_numThreads(struct Arguments* args);
+// 0 means one thread per core
+void Arguments_setNumThreads(struct Arguments* args, int numThreads);
+int Arguments_lazyBodies(struct Arguments* args);
+void Arguments_setLazyBodies(struct Arguments* args, int lazyBodies);
+enum EmitKind Arguments_emitKind(struct Arguments* args);
+void Arguments_setEmitKind(struct Arguments* args, enum EmitKind emitKind);
+char* Arguments_passes(struct Arguments* args);
+void Arguments_setPasses(struct Arguments* args, char* passes);
+int Arguments_timePasses(struct Arguments* args);
+void Arguments_setTimePasses(struct Arguments* args, int timePasses);
 
 #endif
@@ -5,6 +5,8 @@
 #include "Arguments.h"
 
 #include "ast/location.h"
+#include "common/arena.h"
+#include "common/hash-map.h"
 
 #include <stdio.h>
 #include <wchar.h>
@@ -24,19 +26,32 @@ struct Context {
   struct lexer_state* lexer;
 
   struct AstNode* ast;
-  struct Location* locations;
+  // maps each AstNode* to its struct Location*
+  struct HashMap locations;
+  // owns every AST node and the strings they hold
+  struct Arena ast_arena;
 
+  // the file scope, every other scope hangs off of its Block
   struct ScopeResult* scope_table;
 
   struct CompilerBuiltin* compiler_builtins;
 
   struct cg_context* codegen;
+
+  // called before any diagnostic is printed, if set. parallel passes use it
+  // to hold diagnostics back until all earlier work is done, so the first
+  // error reported is the same one a single thread would report
+  void (*diagnostic_gate)(struct Context* context);
+  void* diagnostic_gate_data;
 };
 
 struct Context* Context_allocate();
 void Context_init(struct Context* context, struct Arguments* arguments);
+// frees the AST, nothing built from the context may be used afterwards
+void Context_deinit(struct Context* context);
 
 void BREAKPOINT();
+void Context_begin_diagnostic(struct Context* context);
 
 #define FATAL_EXIT()                                                           \
   do {                                                                         \
@@ -46,6 +61,7 @@ void BREAKPOINT();
 
 #define WARNING_ON_AST(context, ast, format, ...)                              \
   do {                                                                         \
+    Context_begin_diagnostic(context);                                         \
     struct Location* loc = Context_get_location(context, ast);                 \
     if(loc) {                                                                  \
       fwprintf(                                                                \
@@ -86,6 +102,7 @@ void BREAKPOINT();
 
 #define ERROR_ON_LINE(context, lineno, format, ...)                            \
   do {                                                                         \
+    Context_begin_diagnostic(context);                                         \
     fwprintf(                                                                  \
         stderr,                                                                \
         L"%s:%d: error: " format,                                              \
@@ -97,6 +114,7 @@ void BREAKPOINT();
 
 #define ERROR_ON_AST(context, ast, format, ...)                                \
   do {                                                                         \
+    Context_begin_diagnostic(context);                                         \
     struct Location* loc = Context_get_location(context, ast);                 \
     if(loc) {                                                                  \
       ERROR_ON_LINE(context, loc->line_start, format, ##__VA_ARGS__);          \
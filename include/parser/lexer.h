@@ -1,6 +1,7 @@
 #ifndef PEBL_LEXER_H_
 #define PEBL_LEXER_H_
 
+#include "common/arena.h"
 #include "context/context.h"
 
 #include <stdio.h>
@@ -9,71 +10,54 @@
 struct lexer_token;
 
 struct lexer_state {
-  FILE* fp;
+  // the entire source file, decoded up front
+  wchar_t* buffer;
+  int buffer_len;
+  // views lex a range of another lexer's buffer and do not own it
+  int is_view;
+  int position;
   struct lexer_token* peeked[2];
   int current_line;
+
+  // tokens (and any decoded literals) live as long as the lexer does
+  struct Arena token_arena;
 };
 
 enum lexer_tokentype {
-  tt_EOF,
-  tt_ERROR,
-  tt_ID,
-  tt_NUMBER,
-  tt_TRUE,
-  tt_FALSE,
-  tt_NULL,
-  tt_STRING_LITERAL,
-  tt_CHAR_LITERAL,
-  tt_LPAREN,
-  tt_RPAREN,
-  tt_LCURLY,
-  tt_RCURLY,
-  tt_COMMA,
-  tt_DOT,
-  tt_ARROW,
-  tt_COLON,
-  tt_SEMICOLON,
-  tt_FUNC,
-  tt_EXTERN,
-  tt_EXPORT,
-  tt_TYPE,
-  tt_LET,
-  tt_PLUS,
-  tt_MINUS,
-  tt_STAR,
-  tt_DIVIDE,
-  tt_AND,
-  tt_OR,
-  tt_LT,
-  tt_GT,
-  tt_LTEQ,
-  tt_GTEQ,
-  tt_EQ,
-  tt_NEQ,
-  tt_EQUALS,
-  tt_AMPERSAND,
-  tt_NOT,
-  tt_IF,
-  tt_ELSE,
-  tt_WHILE,
-  tt_RETURN,
-  tt_BREAK
+#define TOKEN(name) tt_##name,
+#define KEYWORD(name, spelling) tt_##name,
+#include "definitions/tokens.def"
 };
 wchar_t* tokentype_to_string(enum lexer_tokentype tt);
 
 struct lexer_token {
   enum lexer_tokentype tt;
+  // a view into the source buffer, NOT nul terminated. literals with escape
+  // sequences point to a decoded copy instead
   wchar_t* lexeme;
+  int lexeme_len;
   int lineno;
 };
 
 enum lexer_tokentype LT_type(struct lexer_token* t);
 wchar_t* LT_lexeme(struct lexer_token* t);
+int LT_lexeme_len(struct lexer_token* t);
 int LT_lineno(struct lexer_token* t);
 
 void lexer_init(struct Context* context);
+// lexes [start, end) of `source`'s buffer, starting on line `line`
+void lexer_init_view(
+    struct Context* context,
+    struct lexer_state* source,
+    int start,
+    int end,
+    int line);
 void lexer_deinit(struct Context* context);
 struct lexer_token* lexer_gettoken(struct Context* context);
 struct lexer_token* lexer_peek(struct Context* context, int lookahead);
+// if the next token is '{', skips past its matching '}' by scanning chars
+// rather than lexing, storing where the '{' was. returns 0 without consuming
+// anything if there is no match
+int lexer_skip_block(struct Context* context, int* start, int* start_line);
 
 #endif
@@ -0,0 +1,84 @@
+import argparse as ap
+import sys
+from typing import List, TextIO
+
+# generates a synthetic pebl program for pebl-bench-frontend
+# the output always parses and scope resolves, so every phase can run on it
+
+
+def gen_struct(out: TextIO, index: int, nfields: int):
+    fields = " ".join(f"f{i}:int;" for i in range(nfields))
+    out.write(f"type wide{index} = {{{fields}}}\n")
+
+
+def gen_nested(out: TextIO, depth: int, indent: int, width: int):
+    pad = "  " * indent
+    if depth == 0:
+        out.write(f"{pad}x = x + {indent};\n")
+        return
+    if depth % 2 == 0:
+        out.write(f"{pad}if x > {depth} {{\n")
+        for _ in range(width):
+            gen_nested(out, depth - 1, indent + 1, width)
+        out.write(f"{pad}}} else {{\n")
+        out.write(f"{pad}  x = x - 1;\n")
+        out.write(f"{pad}}}\n")
+    else:
+        out.write(f"{pad}while x < {depth * 100} {{\n")
+        for _ in range(width):
+            gen_nested(out, depth - 1, indent + 1, width)
+        out.write(f"{pad}}}\n")
+
+
+def gen_function(out: TextIO, index: int, args: ap.Namespace):
+    out.write(f"func f{index}(a: int, b: int, s: string): int {{\n")
+    out.write("  let x: int = a + b;\n")
+    if args.structs > 0:
+        struct_index = index % args.structs
+        out.write(f"  let w: wide{struct_index};\n")
+        for i in range(args.fields):
+            out.write(f"  w.f{i} = x + {i};\n")
+    for i in range(args.statements):
+        out.write(f"  let y{i}: int = x * {i};\n")
+        out.write(f"  x = y{i} - a;\n")
+    literal = "s" * args.string_length
+    out.write(f'  let str: string = "{literal}";\n')
+    gen_nested(out, args.depth, 1, args.width)
+    if index > 0:
+        out.write(f"  x = x + f{index - 1}(x, b, str);\n")
+    out.write("  return x;\n")
+    out.write("}\n")
+
+
+def gen_corpus(out: TextIO, args: ap.Namespace):
+    for i in range(args.structs):
+        gen_struct(out, i, args.fields)
+    for i in range(args.functions):
+        gen_function(out, i, args)
+
+
+def main(argv: List[str]):
+    p = ap.ArgumentParser(description="generate a pebl frontend benchmark")
+    p.add_argument("-o", "--output", default=None, help="defaults to stdout")
+    p.add_argument("--functions", type=int, default=200)
+    p.add_argument("--statements", type=int, default=10,
+                   help="straight line statements per function")
+    p.add_argument("--depth", type=int, default=4,
+                   help="nesting depth of if/while blocks per function")
+    p.add_argument("--width", type=int, default=1,
+                   help="blocks at each nesting level")
+    p.add_argument("--string-length", type=int, default=64)
+    p.add_argument("--structs", type=int, default=4)
+    p.add_argument("--fields", type=int, default=16,
+                   help="fields per struct")
+    args = p.parse_args(argv)
+
+    if args.output is None:
+        gen_corpus(sys.stdout, args)
+    else:
+        with open(args.output, "w") as f:
+            gen_corpus(f, args)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -2,23 +2,12 @@
 
 #include "ast/scope-resolve.h"
 #include "common/bsstring.h"
+#include "common/intern.h"
 #include "common/ll-common.h"
 #include "context/context.h"
 
 #include <string.h>
 
-// TODO: DUPLICATED in scope resolve
-static struct Type* Type_allocate(char* name) {
-  struct Type* t = malloc(sizeof(*t));
-  memset(t, 0, sizeof(*t));
-
-  int len = strlen(name) + 1;
-  t->name = malloc(sizeof(*t->name) * len);
-  bsstrcpy(t->name, name);
-
-  return t;
-}
-
 int Type_ptr_size() { return 64; }
 struct Type* Type_int_type(struct Context* ctx, int size) {
   char* name;
@@ -38,26 +27,31 @@ struct Type* Type_void_type(struct Context* ctx) {
 }
 
 static struct Type* Type_allocate_Pointer(struct Type* pointer_to) {
-  struct Type* t = Type_allocate(pointer_to->name);
+  struct Type* t = malloc(sizeof(*t));
+  memset(t, 0, sizeof(*t));
+  // already interned
+  t->name = pointer_to->name;
   t->kind = tk_POINTER;
   t->pointer_to = pointer_to;
   t->size = Type_ptr_size();
   return t;
 }
 
-int Type_eq(struct Type* t1, struct Type* t2) {
-  // follow alias chains
-  t1 = Type_get_base_type(t1);
-  t2 = Type_get_base_type(t2);
-  ASSERT(t1->kind != tk_ALIAS && t2->kind != tk_ALIAS);
-
-  // if both ptr, check pointer_to equivalence
-  if(t1->kind == tk_POINTER && t2->kind == tk_POINTER) {
-    return Type_eq(Type_get_pointee_type(t1), Type_get_pointee_type(t2));
+struct Type* Type_canonical(struct Type* t) {
+  struct Type* cached = atomic_load(&t->canonical);
+  if(cached) return cached;
+  struct Type* base_type = Type_get_base_type(t);
+  struct Type* canonical = base_type;
+  if(base_type->kind == tk_POINTER && base_type->pointer_to) {
+    canonical = Type_get_ptr_type(Type_canonical(base_type->pointer_to));
   }
+  // every thread computes the same canonical type, so a plain store is enough
+  atomic_store(&t->canonical, canonical);
+  return canonical;
+}
 
-  // check name
-  return t1->kind == t2->kind && strcmp(t1->name, t2->name) == 0;
+int Type_eq(struct Type* t1, struct Type* t2) {
+  return Type_canonical(t1) == Type_canonical(t2);
 }
 
 char* Type_to_string(struct Type* type) {
@@ -79,9 +73,23 @@ char* Type_to_string(struct Type* type) {
 }
 
 struct Type* Type_get_ptr_type(struct Type* t) {
-  struct Type* ptr_type = Type_allocate_Pointer(t);
+  struct Type* ptr_type = atomic_load(&t->ptr_type);
+  if(ptr_type) return ptr_type;
+  // if another thread got there first, use its pointer type
+  struct Type* new_ptr_type = Type_allocate_Pointer(t);
+  if(atomic_compare_exchange_strong(&t->ptr_type, &ptr_type, new_ptr_type))
+    return new_ptr_type;
+  free(new_ptr_type);
   return ptr_type;
 }
+void Type_free_ptr_types(struct Type* t) {
+  struct Type* ptr_type = atomic_exchange(&t->ptr_type, NULL);
+  while(ptr_type) {
+    struct Type* next = atomic_exchange(&ptr_type->ptr_type, NULL);
+    free(ptr_type);
+    ptr_type = next;
+  }
+}
 // follow alias chains to base type
 struct Type* Type_get_base_type(struct Type* t) {
   struct Type* ret = t;
@@ -98,9 +106,7 @@ struct Type* Type_get_pointee_type(struct Type* t) {
 
 int Type_get_num_fields(struct Type* t) {
   ASSERT(Type_is_typedef(t));
-  int n = 0;
-  LL_FOREACH(t->fields, f) { n++; }
-  return n;
+  return t->num_fields;
 }
 
 int Type_is_pointer(struct Type* t) {
@@ -113,52 +119,72 @@ int Type_is_opaque(struct Type* t) {
 }
 
 int Type_is_signed(struct Type* t) {
-  // all integers are signed, everything else is unsigned
-  return Type_is_integer(t);
+  return Type_get_base_type(t)->is_signed;
 }
 int Type_is_integer(struct Type* t) {
-  struct Type* base_type = Type_get_base_type(t);
-  if(base_type->kind == tk_BUILTIN) {
-    return strcmp(base_type->name, "int64") == 0 ||
-           strcmp(base_type->name, "int8") == 0 ||
-           strcmp(base_type->name, "char") == 0;
-  }
-  return 0;
+  return Type_get_base_type(t)->is_integer;
 }
 int Type_is_void(struct Type* t) {
-  struct Type* base_type = Type_get_base_type(t);
-  return base_type->kind == tk_BUILTIN && strcmp(base_type->name, "void") == 0;
+  return Type_get_base_type(t)->builtin == btk_void;
 }
 int Type_is_boolean(struct Type* t) {
-  struct Type* base_type = Type_get_base_type(t);
-  return base_type->kind == tk_BUILTIN && strcmp(base_type->name, "bool") == 0;
+  return Type_get_base_type(t)->builtin == btk_bool;
 }
 
 int Type_get_size(struct Type* t) { return Type_get_base_type(t)->size; }
 
 int Type_is_typedef(struct Type* t) { return t->kind == tk_TYPEDEF; }
-struct TypeField* Type_get_TypeField(struct Type* t, char* name) {
-  ASSERT(Type_is_typedef(t));
-  LL_FOREACH(t->fields, field) {
-    if(strcmp(field->name, name) == 0) {
-      return field;
-    }
+
+// alignment in bits, every builtin is aligned to its size in bytes
+static int Type_get_align(struct Type* t) {
+  struct Type* base_type = Type_get_base_type(t);
+  if(base_type->kind == tk_TYPEDEF) {
+    ASSERT_MSG(base_type->align > 0, "typedef has no layout yet");
+    return base_type->align;
   }
-  return NULL;
+  if(base_type->size <= 8) return 8;
+  return base_type->size;
 }
-int TypeField_get_index(struct TypeField* tf) {
-  int idx = 0;
-  LL_FOREACH(tf->parentType->fields, field) {
-    if(tf == field) return idx;
-    idx++;
-  }
-  return -1;
+static int align_to(int offset, int align) {
+  return (offset + align - 1) / align * align;
 }
-int TypeField_get_offset(struct TypeField* tf) {
+
+void Type_freeze_fields(struct Type* t) {
+  ASSERT(Type_is_typedef(t));
+  int n = 0;
+  LL_FOREACH(t->fields, field) { n++; }
+  t->field_array = malloc(sizeof(*t->field_array) * n);
+  t->num_fields = n;
+  HashMap_init_pointers(&t->fields_by_name);
+
   int offset = 0;
-  LL_FOREACH(tf->parentType->fields, field) {
-    if(tf == field) return offset;
-    offset += Type_get_size(field->type);
+  int align = 8;
+  LL_FOREACH_ENUMERATE(t->fields, field, i) {
+    t->field_array[i] = field;
+    field->index = i;
+    HashMap_put_new(&t->fields_by_name, field->name, field);
+
+    int field_align = Type_get_align(field->type);
+    if(field_align > align) align = field_align;
+    offset = align_to(offset, field_align);
+    field->offset = offset;
+    // an empty size (void) or unknown size (opaque) takes no space
+    int field_size = Type_get_size(field->type);
+    if(field_size > 0) offset += align_to(field_size, 8);
   }
-  return -1;
+  t->align = align;
+  t->size = align_to(offset, align);
+}
+void Type_free_fields(struct Type* t) {
+  ASSERT(Type_is_typedef(t));
+  free(t->field_array);
+  t->field_array = NULL;
+  t->num_fields = 0;
+  HashMap_deinit(&t->fields_by_name);
+}
+struct TypeField* Type_get_TypeField(struct Type* t, char* name) {
+  ASSERT(Type_is_typedef(t));
+  return HashMap_get(&t->fields_by_name, intern(name));
 }
+int TypeField_get_index(struct TypeField* tf) { return tf->index; }
+int TypeField_get_offset(struct TypeField* tf) { return tf->offset; }
@@ -1,21 +1,16 @@
 #include "ast/ast.h"
 
+#include "common/arena.h"
 #include "common/bsstring.h"
 #include "common/ll-common.h"
 #include "context/context.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-struct AstNode* ast_allocate(enum AstType at) {
-  struct AstNode* ast = malloc(sizeof(*ast));
-  memset(ast, 0, sizeof(*ast));
-  ast->at = at;
-  return ast;
-}
-
 struct AstNode* ast_next(struct AstNode* ast) { return ast->next; }
 void ast_append(struct AstNode** head, struct AstNode* tail) {
   ASSERT(head != NULL);
@@ -25,8 +20,7 @@ enum AstType ast_type(struct AstNode* ast) { return ast->at; }
 int ast_is_type(struct AstNode* ast, enum AstType at) {
   return ast_type(ast) == at;
 }
-int ast_num_children(struct AstNode* ast) {
-  enum AstType at = ast_type(ast);
+static int ast_type_num_children(enum AstType at) {
   if(at == ast_FieldAccess) return 2;
   else if(at == ast_Type) return 2;
   else if(at == ast_Variable) return 3;
@@ -40,6 +34,66 @@ int ast_num_children(struct AstNode* ast) {
   else if(at == ast_Call) return 2;
   return 0;
 }
+int ast_num_children(struct AstNode* ast) {
+  return ast_type_num_children(ast_type(ast));
+}
+
+// each thread parsing builds into its own arena
+static _Thread_local struct Arena* ast_arena = NULL;
+
+struct Arena* ast_set_arena(struct Arena* arena) {
+  struct Arena* prev = ast_arena;
+  ast_arena = arena;
+  return prev;
+}
+
+// zeroed memory that lives as long as the AST
+static void* ast_allocate_bytes(size_t size) {
+  if(ast_arena) return Arena_allocate(ast_arena, size);
+  return calloc(1, size);
+}
+
+static size_t ast_node_size(enum AstType at) {
+  size_t payload;
+  if(at == ast_Identifier || at == ast_Typename) payload = sizeof(char*);
+  else if(at == ast_String) payload = sizeof(wchar_t*);
+  else if(at == ast_Number) payload = sizeof(struct AstNode_Number);
+  else if(at == ast_Block) payload = sizeof(((struct AstNode*)0)->block);
+  else payload = ast_type_num_children(at) * sizeof(struct AstNode*);
+  return offsetof(struct AstNode, children) + payload;
+}
+
+// expressions carry their resolved type after the payload
+static int ast_type_has_resolved_type(enum AstType at) {
+  return at == ast_Identifier || at == ast_Typename || at == ast_Number ||
+         at == ast_String || at == ast_Expr || at == ast_Call ||
+         at == ast_FieldAccess;
+}
+static struct Type** ast_resolved_type_slot(struct AstNode* ast) {
+  return (struct Type**)((char*)ast + ast_node_size(ast_type(ast)));
+}
+struct Type* ast_resolved_type(struct AstNode* ast) {
+  if(!ast_type_has_resolved_type(ast_type(ast))) return NULL;
+  return *ast_resolved_type_slot(ast);
+}
+void ast_set_resolved_type(struct AstNode* ast, struct Type* type) {
+  if(!ast_type_has_resolved_type(ast_type(ast))) return;
+  *ast_resolved_type_slot(ast) = type;
+}
+
+struct AstNode* ast_allocate(enum AstType at) {
+  size_t size = ast_node_size(at);
+  if(ast_type_has_resolved_type(at)) size += sizeof(struct Type*);
+  struct AstNode* ast = ast_allocate_bytes(size);
+  ast->at = at;
+  return ast;
+}
+static int ast_list_length(struct AstNode* list) {
+  int n = 0;
+  ast_foreach(list, a) { n += 1; }
+  return n;
+}
+
 struct AstNode* ast_get_child(struct AstNode* ast, int i) {
   return ast->children[i];
 }
@@ -297,9 +351,7 @@ void verify_ast(struct Context* context) {
 
 struct AstNode* ast_build_Identifier(char* name) {
   struct AstNode* ast = ast_allocate(ast_Identifier);
-  int len = strlen(name) + 1;
-  ast->str_value = malloc(sizeof(*ast->str_value) * len);
-  bsstrcpy(ast->str_value, name);
+  ast->str_value = name;
   return ast;
 }
 int ast_verify_Identifier(struct AstNode* ast) {
@@ -312,9 +364,7 @@ struct AstNode* ast_build_Typename(char* name) {
 }
 struct AstNode* ast_build_Typename2(char* name, int ptr_level) {
   struct AstNode* ast = ast_allocate(ast_Typename);
-  int len = strlen(name) + 1;
-  ast->str_value = malloc(sizeof(*ast->str_value) * len);
-  bsstrcpy(ast->str_value, name);
+  ast->str_value = name;
   ast->int_value = ptr_level;
   return ast;
 }
@@ -427,6 +477,7 @@ struct AstNode* ast_build_FunctionHeader(
   ast->children[0] = name;
   ast->children[1] = args;
   ast->children[2] = ret_type;
+  ast->int_value2 = ast_list_length(args);
   return ast;
 }
 struct AstNode* ast_build_ExternFunction(struct AstNode* header) {
@@ -456,12 +507,7 @@ struct AstNode* ast_Function_name(struct AstNode* ast) {
 struct AstNode* ast_Function_args(struct AstNode* ast) {
   return ast->children[1];
 }
-int ast_Function_num_args(struct AstNode* ast) {
-  struct AstNode* args = ast_Function_args(ast);
-  int n = 0;
-  ast_foreach(args, a) { n += 1; }
-  return n;
-}
+int ast_Function_num_args(struct AstNode* ast) { return ast->int_value2; }
 struct AstNode* ast_Function_ret_type(struct AstNode* ast) {
   return ast->children[2];
 }
@@ -532,6 +578,15 @@ int ast_verify_Block(struct AstNode* ast) {
 struct AstNode* ast_Block_stmts(struct AstNode* ast) {
   return ast->children[0];
 }
+void ast_Block_set_stmts(struct AstNode* ast, struct AstNode* stmts) {
+  ast->children[0] = stmts;
+}
+struct ScopeResult* ast_Block_scope(struct AstNode* ast) {
+  return ast->block.scope;
+}
+void ast_Block_set_scope(struct AstNode* ast, struct ScopeResult* scope) {
+  ast->block.scope = scope;
+}
 int ast_Block_is_empty(struct AstNode* ast) {
   return ast_Block_stmts(ast) == NULL;
 }
@@ -621,6 +676,7 @@ struct AstNode* ast_build_Call(struct AstNode* name, struct AstNode* args) {
   struct AstNode* ast = ast_allocate(ast_Call);
   ast->children[0] = name;
   ast->children[1] = args;
+  ast->int_value2 = ast_list_length(args);
   return ast;
 }
 int ast_verify_Call(struct AstNode* ast) {
@@ -632,18 +688,12 @@ int ast_verify_Call(struct AstNode* ast) {
 struct AstNode* ast_Call_name(struct AstNode* ast) { return ast->children[0]; }
 struct AstNode* ast_Call_args(struct AstNode* ast) { return ast->children[1]; }
 
-int ast_Call_num_args(struct AstNode* ast) {
-  struct AstNode* args = ast_Call_args(ast);
-  int n = 0;
-  ast_foreach(args, a) { n += 1; }
-  return n;
-}
+int ast_Call_num_args(struct AstNode* ast) { return ast->int_value2; }
 
 struct AstNode* ast_build_Number(int64_t value, int size) {
   struct AstNode* ast = ast_allocate(ast_Number);
-  ast->node_information = malloc(sizeof(*ast->node_information));
-  ((struct AstNode_Number*)ast->node_information)->value = value;
-  ((struct AstNode_Number*)ast->node_information)->size = size;
+  ast->number.value = value;
+  ast->number.size = size;
   return ast;
 }
 int ast_verify_Number(struct AstNode* ast) {
@@ -651,17 +701,20 @@ int ast_verify_Number(struct AstNode* ast) {
 }
 
 int64_t ast_Number_value(struct AstNode* ast) {
-  return ((struct AstNode_Number*)ast->node_information)->value;
+  return ast->number.value;
 }
 int ast_Number_size(struct AstNode* ast) {
-  return ((struct AstNode_Number*)ast->node_information)->size;
+  return ast->number.size;
 }
 
 struct AstNode* ast_build_String(wchar_t* value) {
+  return ast_build_String2(value, wcslen(value));
+}
+struct AstNode* ast_build_String2(wchar_t* value, int len) {
   struct AstNode* ast = ast_allocate(ast_String);
-  int len = wcslen(value) + 1;
-  ast->wstr_value = malloc(sizeof(*ast->wstr_value) * len);
-  peblwstrcpy(ast->wstr_value, value);
+  ast->wstr_value = ast_allocate_bytes(sizeof(*ast->wstr_value) * (len + 1));
+  wmemcpy(ast->wstr_value, value, len);
+  ast->wstr_value[len] = L'\0';
   return ast;
 }
 int ast_verify_String(struct AstNode* ast) {
@@ -2,21 +2,20 @@
 #include "ast/location.h"
 
 #include "ast/ast.h"
-#include "common/ll-common.h"
+#include "common/hash-map.h"
 #include "context/context.h"
 
 #include <string.h>
 
 void Context_add_location(struct Context* context, struct Location* loc) {
-  LL_APPEND(context->locations, loc);
+  HashMap_put_new(&context->locations, loc->ast, loc);
 }
 struct Location* Context_build_location(
     struct Context* context,
     struct AstNode* ast,
     int line_start,
     int line_end) {
-  struct Location* l = malloc(sizeof(*l));
-  memset(l, 0, sizeof(*l));
+  struct Location* l = Arena_allocate(&context->ast_arena, sizeof(*l));
   l->ast = ast;
   l->line_start = line_start;
   l->line_end = line_end;
@@ -26,8 +25,5 @@ struct Location* Context_build_location(
 struct Location*
 Context_get_location(struct Context* context, struct AstNode* ast) {
   if(!ast) return NULL;
-  LL_FOREACH(context->locations, loc) {
-    if(loc->ast == ast) return loc;
-  }
-  return NULL;
+  return HashMap_get(&context->locations, ast);
 }
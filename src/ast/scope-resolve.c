@@ -1,25 +1,40 @@
 #include "ast/scope-resolve.h"
 
 #include "ast/ast.h"
+#include "common/arena.h"
 #include "common/bsstring.h"
+#include "common/intern.h"
 #include "common/ll-common.h"
+#include "common/thread-pool.h"
+#include "context/arguments.h"
 #include "context/context.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <threads.h>
+
+// each thread resolving function bodies allocates from its own arena
+static _Thread_local struct Arena* scope_arena = NULL;
+// how many file scope symbols the body being resolved on this thread can see,
+// -1 for all of them
+static _Thread_local int file_scope_visible = -1;
+
+// zeroed memory that lives as long as the scopes
+static void* scope_allocate_bytes(size_t size) {
+  if(scope_arena) return Arena_allocate(scope_arena, size);
+  return calloc(1, size);
+}
 
 static struct ScopeSymbol* ScopeSymbol_allocate(enum ScopeSymbolType sst) {
-  struct ScopeSymbol* ss = malloc(sizeof(*ss));
-  memset(ss, 0, sizeof(*ss));
+  struct ScopeSymbol* ss = scope_allocate_bytes(sizeof(*ss));
   ss->sst = sst;
   return ss;
 }
 
 static struct ScopeVariable*
 ScopeVariable_allocate(struct AstNode* variable, struct Type* type) {
-  struct ScopeVariable* var = malloc(sizeof(*var));
-  memset(var, 0, sizeof(*var));
+  struct ScopeVariable* var = scope_allocate_bytes(sizeof(*var));
   var->variable = variable;
   var->type = type;
 
@@ -32,19 +47,26 @@ ScopeSymbol_init_var(struct AstNode* variable, struct Type* type) {
   ss->ss_variable = ScopeVariable_allocate(variable, type);
   return ss;
 }
+// returns the one symbol for `type`
 static struct ScopeSymbol* ScopeSymbol_init_type(struct Type* type) {
+  struct ScopeSymbol* symbol = atomic_load(&type->symbol);
+  if(symbol) return symbol;
   struct ScopeSymbol* ss = ScopeSymbol_allocate(sst_Type);
   ss->ss_type = type;
-
+  // if another thread got there first, this symbol is just never used
+  if(!atomic_compare_exchange_strong(&type->symbol, &symbol, ss)) return symbol;
   return ss;
 }
 
-static struct ScopeSymbol*
-ScopeSymbol_init_builtin(char* name, int num_args, struct Type* rettype) {
+static struct ScopeSymbol* ScopeSymbol_init_builtin(
+    enum CompilerBuiltinKind kind,
+    char* name,
+    int num_args,
+    struct Type* rettype) {
   struct ScopeSymbol* ss = ScopeSymbol_allocate(sst_Builtin);
-  ss->ss_builtin = malloc(sizeof(*ss->ss_builtin));
-  memset(ss->ss_builtin, 0, sizeof(*ss->ss_builtin));
-  ss->ss_builtin->name = bsstrdup(name);
+  ss->ss_builtin = scope_allocate_bytes(sizeof(*ss->ss_builtin));
+  ss->ss_builtin->kind = kind;
+  ss->ss_builtin->name = intern(name);
   ss->ss_builtin->num_args = num_args;
   ss->ss_builtin->rettype = rettype;
   return ss;
@@ -53,12 +75,11 @@ static struct ScopeFunction* ScopeFunction_allocate(
     struct AstNode* function,
     struct Type* rettype,
     int num_args) {
-  struct ScopeFunction* func = malloc(sizeof(*func));
-  memset(func, 0, sizeof(*func));
+  struct ScopeFunction* func = scope_allocate_bytes(sizeof(*func));
   func->function = function;
   func->rettype = rettype;
   func->num_args = num_args;
-  func->args = malloc(sizeof(*func->args) * func->num_args);
+  func->args = scope_allocate_bytes(sizeof(*func->args) * func->num_args);
   return func;
 }
 
@@ -78,14 +99,37 @@ static struct ScopeResult* allocate_ScopeResult(
     struct AstNode* ast,
     struct ScopeResult* parent) {
   ASSERT(ast_is_type(ast, ast_Block));
-  struct ScopeResult* sr = malloc(sizeof(*sr));
-  memset(sr, 0, sizeof(*sr));
+  struct ScopeResult* sr = scope_allocate_bytes(sizeof(*sr));
   sr->ast = ast;
   sr->parent_scope = parent;
-  LL_APPEND(ctx->scope_table, sr);
+  HashMap_init_pointers(&sr->symbols_by_name);
+  ast_Block_set_scope(ast, sr);
+  if(!parent) ctx->scope_table = sr;
   return sr;
 }
 
+static void
+ScopeResult_add_symbol(struct ScopeResult* sr, struct ScopeSymbol* ss) {
+  ss->order = sr->num_symbols++;
+  LL_APPEND_TAIL(sr->symbols, sr->symbols_tail, ss);
+  HashMap_put_new(&sr->symbols_by_name, ScopeSymbol_name(ss), ss);
+}
+
+// `name` must be interned
+static struct ScopeSymbol*
+scope_lookup_interned(struct ScopeResult* sr, char* name, int search_parent) {
+  for(; sr; sr = search_parent ? sr->parent_scope : NULL) {
+    struct ScopeSymbol* sym = HashMap_get(&sr->symbols_by_name, name);
+    if(!sym) continue;
+    // a body resolved in parallel only sees what was declared before it
+    if(!sr->parent_scope && file_scope_visible >= 0 &&
+       sym->order >= file_scope_visible)
+      continue;
+    return sym;
+  }
+  return NULL;
+}
+
 static void check_for_redefinition(
     struct Context* ctx,
     struct ScopeResult* sr,
@@ -103,7 +147,7 @@ static void check_for_redefinition(
   } else {
     UNIMPLEMENTED("unimplemented redefintion check\n");
   }
-  struct ScopeSymbol* ss = scope_lookup_name(ctx, sr, name, 0);
+  struct ScopeSymbol* ss = scope_lookup_interned(sr, name, 0);
   if(ss) {
     ERROR_ON_AST(ctx, ast, "cannot redefine %s '%s'\n", redef_type, name);
   }
@@ -135,35 +179,34 @@ static struct ScopeSymbol* build_ScopeSymbol_for_variable(
     }
   }
   struct ScopeSymbol* ss = ScopeSymbol_init_var(var, type);
-  LL_APPEND(sr->symbols, ss);
+  ScopeResult_add_symbol(sr, ss);
 
   return ss;
 }
 
 static struct Type* Type_allocate(char* name) {
-  struct Type* t = malloc(sizeof(*t));
-  memset(t, 0, sizeof(*t));
-
-  int len = strlen(name) + 1;
-  t->name = malloc(sizeof(*t->name) * len);
-  bsstrcpy(t->name, name);
-
+  struct Type* t = scope_allocate_bytes(sizeof(*t));
+  t->name = intern(name);
   return t;
 }
 
 static struct TypeField* TypeField_allocate(char* name) {
-  struct TypeField* t = malloc(sizeof(*t));
-  memset(t, 0, sizeof(*t));
-
-  int len = strlen(name) + 1;
-  t->name = malloc(sizeof(*t->name) * len);
-  bsstrcpy(t->name, name);
+  struct TypeField* t = scope_allocate_bytes(sizeof(*t));
+  t->name = intern(name);
   return t;
 }
 
-static void Type_init_Builtin(struct Type* t, int size) {
+static void Type_init_Builtin(
+    struct Type* t,
+    enum BuiltinTypeKind builtin,
+    int size,
+    int is_integer,
+    int is_signed) {
   t->kind = tk_BUILTIN;
+  t->builtin = builtin;
   t->size = size;
+  t->is_integer = is_integer;
+  t->is_signed = is_signed;
 }
 
 static void Type_init_Alias(struct Type* t, struct Type* alias_of) {
@@ -184,7 +227,7 @@ static void Type_init_Typedef(
     struct Type* t,
     struct AstNode* args) {
   t->kind = tk_TYPEDEF;
-  int size = 0;
+  struct TypeField* fields_tail = NULL;
   ast_foreach(args, a) {
     ASSERT(ast_is_type(a, ast_Variable));
 
@@ -195,11 +238,20 @@ static void Type_init_Typedef(
       ERROR_ON_AST(ctx, a, "cannot infer type for '%s'\n", fieldName);
     }
     newField->type = scope_get_Type_from_ast(ctx, sr, typename, 1);
+    // a typedef without a layout yet is the one being built, it cannot
+    // contain itself
+    struct Type* base_type = Type_get_base_type(newField->type);
+    if(Type_is_typedef(base_type) && base_type->align == 0) {
+      ERROR_ON_AST(
+          ctx,
+          a,
+          "type '%s' cannot contain itself by value\n",
+          base_type->name);
+    }
     newField->parentType = t;
-    size += newField->type->size;
-    LL_APPEND(t->fields, newField);
+    LL_APPEND_TAIL(t->fields, fields_tail, newField);
   }
-  t->size = size;
+  Type_freeze_fields(t);
 }
 
 static struct ScopeSymbol* build_ScopeSymbol_for_type(
@@ -212,7 +264,7 @@ static struct ScopeSymbol* build_ScopeSymbol_for_type(
   char* name = ast_Identifier_name(ast_Type_name(type_ast));
   struct Type* type = Type_allocate(name);
   struct ScopeSymbol* ss = ScopeSymbol_init_type(type);
-  LL_APPEND(sr->symbols, ss);
+  ScopeResult_add_symbol(sr, ss);
 
   if(ast_Type_is_opaque(type_ast)) {
     Type_init_Opaque(type);
@@ -233,10 +285,109 @@ static void scope_resolve_internal(
     struct ScopeResult* scope,
     struct AstNode* ast);
 
+// function bodies only add to their own scopes and read the file scope, so
+// once the file scope is built they can be resolved in parallel
+struct BodyJob {
+  struct ScopeJobs* jobs;
+  struct Context context;
+  struct ScopeResult* scope;
+  int index;
+  int file_scope_visible;
+  struct Arena arena;
+  int done;
+  struct BodyJob* next;
+};
+
+struct ScopeJobs {
+  struct Context* context;
+  struct ThreadPool* pool;
+  mtx_t lock;
+  // signaled whenever more of the jobs in source order are done
+  cnd_t progress;
+  struct BodyJob* head;
+  struct BodyJob* tail;
+  // every job before this one is done
+  struct BodyJob* first_pending;
+  // jobs from here on are queued but not given to the pool yet
+  struct BodyJob* first_unsubmitted;
+  int n_jobs;
+  int n_done;
+};
+
+static void wait_for_jobs(struct ScopeJobs* jobs, int n) {
+  mtx_lock(&jobs->lock);
+  while(jobs->n_done < n)
+    cnd_wait(&jobs->progress, &jobs->lock);
+  mtx_unlock(&jobs->lock);
+}
+
+static void resolve_body_job(void* arg) {
+  struct BodyJob* job = arg;
+  scope_arena = &job->arena;
+  file_scope_visible = job->file_scope_visible;
+  ast_foreach(ast_Block_stmts(job->scope->ast), s) {
+    scope_resolve_internal(&job->context, job->scope, s);
+  }
+  scope_arena = NULL;
+  file_scope_visible = -1;
+
+  struct ScopeJobs* jobs = job->jobs;
+  mtx_lock(&jobs->lock);
+  job->done = 1;
+  while(jobs->first_pending && jobs->first_pending->done) {
+    jobs->first_pending = jobs->first_pending->next;
+    jobs->n_done++;
+  }
+  cnd_broadcast(&jobs->progress);
+  mtx_unlock(&jobs->lock);
+}
+
+// resolves every body queued so far. the file scope must not change while
+// the pool reads it
+static void run_queued_jobs(struct ScopeJobs* jobs) {
+  for(; jobs->first_unsubmitted;
+      jobs->first_unsubmitted = jobs->first_unsubmitted->next) {
+    ThreadPool_submit(jobs->pool, resolve_body_job, jobs->first_unsubmitted);
+  }
+  wait_for_jobs(jobs, jobs->n_jobs);
+}
+
+// a body only reports a diagnostic once all earlier bodies resolved cleanly
+static void body_job_diagnostic_gate(struct Context* context) {
+  struct BodyJob* job = context->diagnostic_gate_data;
+  wait_for_jobs(job->jobs, job->index);
+}
+// the file scope diagnostics come after the bodies before them
+static void file_scope_diagnostic_gate(struct Context* context) {
+  run_queued_jobs(context->diagnostic_gate_data);
+}
+
+static void queue_body(struct ScopeJobs* jobs, struct ScopeResult* scope) {
+  struct BodyJob* job = malloc(sizeof(*job));
+  memset(job, 0, sizeof(*job));
+  job->jobs = jobs;
+  job->scope = scope;
+  job->index = jobs->n_jobs++;
+  job->file_scope_visible = scope->parent_scope->num_symbols;
+  job->context = *jobs->context;
+  job->context.diagnostic_gate = body_job_diagnostic_gate;
+  job->context.diagnostic_gate_data = job;
+  // bodies are usually small, so start with a small arena
+  Arena_init(&job->arena, 4096);
+
+  if(jobs->tail) jobs->tail->next = job;
+  else jobs->head = job;
+  jobs->tail = job;
+  if(!jobs->first_pending) jobs->first_pending = job;
+  if(!jobs->first_unsubmitted) jobs->first_unsubmitted = job;
+}
+
+// when `jobs` is set the body is queued instead of resolved here
 static void add_body_to_func_sym(
     struct Context* ctx,
     struct ScopeResult* sr,
-    struct ScopeSymbol* func_sym) {
+    struct ScopeSymbol* func_sym,
+    struct ScopeJobs* jobs) {
   ASSERT(func_sym->sst == sst_Function);
   struct AstNode* func = func_sym->ss_function->function;
   // build the arguments into the ScopeFunction entry
@@ -257,7 +408,11 @@ static void add_body_to_func_sym(
   struct AstNode* body = ast_Function_body(func);
   struct ScopeResult* body_scope = allocate_ScopeResult(ctx, body, sr);
   for(int i = 0; i < func_sym->ss_function->num_args; i++) {
-    LL_APPEND(body_scope->symbols, func_sym->ss_function->args[i]);
+    ScopeResult_add_symbol(body_scope, func_sym->ss_function->args[i]);
+  }
+  if(jobs) {
+    queue_body(jobs, body_scope);
+    return;
   }
   // traverse the body
   ast_foreach(ast_Block_stmts(body), s) {
@@ -268,11 +423,12 @@ static void add_body_to_func_sym(
 static struct ScopeSymbol* build_ScopeSymbol_for_func(
     struct Context* ctx,
     struct ScopeResult* sr,
-    struct AstNode* func) {
+    struct AstNode* func,
+    struct ScopeJobs* jobs) {
   ASSERT(ast_is_type(func, ast_Function));
 
   char* name = ast_Identifier_name(ast_Function_name(func));
-  struct ScopeSymbol* ss = scope_lookup_name(ctx, sr, name, 0);
+  struct ScopeSymbol* ss = scope_lookup_interned(sr, name, 0);
   if(ss) {
     if(ss->sst == sst_Function &&
        ast_Function_has_body(ss->ss_function->function) &&
@@ -285,7 +441,7 @@ static struct ScopeSymbol* build_ScopeSymbol_for_func(
         ast_Function_has_body(func)) {
       // need to add a body
       ss->ss_function->function = func;
-      add_body_to_func_sym(ctx, sr, ss);
+      add_body_to_func_sym(ctx, sr, ss, jobs);
       return ss;
     } else {
       ERROR_ON_AST(ctx, func, "cannot redefine function '%s'\n", name);
@@ -296,9 +452,9 @@ static struct ScopeSymbol* build_ScopeSymbol_for_func(
   struct AstNode* rettype_typename = ast_Function_ret_type(func);
   struct Type* rettype = scope_get_Type_from_ast(ctx, sr, rettype_typename, 1);
   struct ScopeSymbol* func_ss = ScopeSymbol_init_func(func, rettype);
-  LL_APPEND(sr->symbols, func_ss);
+  ScopeResult_add_symbol(sr, func_ss);
   if(ast_Function_has_body(func)) {
-    add_body_to_func_sym(ctx, sr, func_ss);
+    add_body_to_func_sym(ctx, sr, func_ss, jobs);
   }
 
   return func_ss;
@@ -311,7 +467,7 @@ static void scope_resolve_internal(
   if(ast_is_type(ast, ast_Variable)) {
     build_ScopeSymbol_for_variable(ctx, scope, ast);
   } else if(ast_is_type(ast, ast_Function)) {
-    build_ScopeSymbol_for_func(ctx, scope, ast);
+    build_ScopeSymbol_for_func(ctx, scope, ast, NULL);
   } else if(ast_is_type(ast, ast_Type)) {
     build_ScopeSymbol_for_type(ctx, scope, ast);
   } else if(ast_is_type(ast, ast_Block)) {
@@ -359,8 +515,7 @@ int ScopeSymbol_eq(struct ScopeSymbol* lhs, struct ScopeSymbol* rhs) {
   } else if(ScopeSymbol_isFunction(lhs) && ScopeSymbol_isFunction(rhs)) {
     return lhs->ss_function->function == rhs->ss_function->function;
   } else if(ScopeSymbol_isBuiltin(lhs) && ScopeSymbol_isBuiltin(rhs)) {
-    return lhs->ss_builtin->num_args == rhs->ss_builtin->num_args &&
-           strcmp(lhs->ss_builtin->name, rhs->ss_builtin->name) == 0;
+    return lhs->ss_builtin->kind == rhs->ss_builtin->kind;
   } else if(ScopeSymbol_isType(lhs) && ScopeSymbol_isType(rhs)) {
     return Type_eq(lhs->ss_type, rhs->ss_type);
   }
@@ -379,29 +534,13 @@ int ScopeSymbol_isBuiltin(struct ScopeSymbol* sym) {
 }
 int ScopeSymbol_isType(struct ScopeSymbol* sym) { return sym->sst == sst_Type; }
 
-struct ScopeResult* scope_lookup(struct Context* ctx, struct AstNode* ast) {
+struct ScopeResult* scope_lookup(
+    __attribute__((unused)) struct Context* ctx,
+    struct AstNode* ast) {
   ASSERT(ast_is_type(ast, ast_Block));
-  // lookup existing scopes
-  LL_FOREACH(ctx->scope_table, sr) {
-    if(sr->ast == ast) {
-      return sr;
-    }
-  }
-  return NULL;
+  return ast_Block_scope(ast);
 }
 
-// BUILTIN(name, size)
-// ALIAS(name, alias_to)
-// PTR_ALIAS(name, alias_to_basetpy)
-#define BUILTIN_TYPES(BUILTIN, ALIAS, PTR_ALIAS)                               \
-  BUILTIN(void, 0)                                                             \
-  BUILTIN(int64, 64)                                                           \
-  BUILTIN(int8, 8)                                                             \
-  BUILTIN(bool, 1)                                                             \
-  BUILTIN(char, (sizeof(wchar_t) * 8))                                         \
-  ALIAS(int, int64)                                                            \
-  PTR_ALIAS(string, char)
-
 static void install_builtins(struct Context* ctx, struct ScopeResult* scope) {
 
 #define ALLOCATE_TYPE(type, name)                                              \
@@ -411,22 +550,22 @@ static void install_builtins(struct Context* ctx, struct ScopeResult* scope) {
     ASSERT_MSG(!builtin_ss, "builtin already exists");                         \
     type = Type_allocate(name);                                                \
     builtin_ss = ScopeSymbol_init_type(type);                                  \
-    LL_APPEND(scope->symbols, builtin_ss);                                     \
+    ScopeResult_add_symbol(scope, builtin_ss);                                 \
   } while(0)
 
-#define MAKE_BUILTIN(name, size)                                               \
+#define BUILTIN_TYPE(name, size, is_integer, is_signed)                        \
   do {                                                                         \
     ALLOCATE_TYPE(type, #name);                                                \
-    Type_init_Builtin(type, size);                                             \
+    Type_init_Builtin(type, btk_##name, size, is_integer, is_signed);          \
   } while(0);
-#define MAKE_ALIAS(name, alias_to)                                             \
+#define BUILTIN_TYPE_ALIAS(name, alias_to)                                     \
   do {                                                                         \
     struct Type* t_alias_to =                                                  \
         scope_get_Type_from_name(ctx, scope, #alias_to, 0);                    \
     ALLOCATE_TYPE(type, #name);                                                \
     Type_init_Alias(type, t_alias_to);                                         \
   } while(0);
-#define MAKE_PTR_ALIAS(name, alias_to)                                         \
+#define BUILTIN_TYPE_PTR_ALIAS(name, alias_to)                                 \
   do {                                                                         \
     struct Type* t_alias_to =                                                  \
         scope_get_Type_from_name(ctx, scope, #alias_to, 0);                    \
@@ -434,10 +573,7 @@ static void install_builtins(struct Context* ctx, struct ScopeResult* scope) {
     Type_init_Alias(type, Type_get_ptr_type(t_alias_to));                      \
   } while(0);
 
-  BUILTIN_TYPES(MAKE_BUILTIN, MAKE_ALIAS, MAKE_PTR_ALIAS)
-#undef MAKE_BUILTIN
-#undef MAKE_ALIAS
-#undef MAKE_PTR_ALIAS
+#include "definitions/builtin-types.def"
 #undef ALLOCATE_TYPE
 
 #define GET_TYPE_GENERIC(name)                                                 \
@@ -451,50 +587,105 @@ static void install_builtins(struct Context* ctx, struct ScopeResult* scope) {
     struct ScopeSymbol* builtin_ss = scope_lookup_name(ctx, scope, #name, 0);  \
     ASSERT_MSG(!builtin_ss, "builtin already exists");                         \
     struct Type* type = GET_TYPE_GENERIC(retType);                             \
-    builtin_ss = ScopeSymbol_init_builtin(#name, numArgs, type);               \
-    LL_APPEND(scope->symbols, builtin_ss);                                     \
+    builtin_ss =                                                               \
+        ScopeSymbol_init_builtin(cb_##codegenFunc, #name, numArgs, type);      \
+    ScopeResult_add_symbol(scope, builtin_ss);                                 \
   } while(0);
 #include "definitions/builtins.def"
 #undef GET_TYPE_GENERIC
 }
 
+// the file scope is built here while function bodies are queued, then the
+// bodies are resolved on the pool
+static void
+scope_resolve_parallel(struct Context* ctx, struct ScopeResult* scope) {
+  struct ScopeJobs jobs;
+  memset(&jobs, 0, sizeof(jobs));
+  jobs.context = ctx;
+  mtx_init(&jobs.lock, mtx_plain);
+  cnd_init(&jobs.progress);
+  jobs.pool = ThreadPool_create(Arguments_numThreads(ctx->arguments));
+  ctx->diagnostic_gate = file_scope_diagnostic_gate;
+  ctx->diagnostic_gate_data = &jobs;
+
+  ast_foreach(ast_Block_stmts(scope->ast), s) {
+    if(ast_is_type(s, ast_Function))
+      build_ScopeSymbol_for_func(ctx, scope, s, &jobs);
+    else scope_resolve_internal(ctx, scope, s);
+  }
+  run_queued_jobs(&jobs);
+  ThreadPool_destroy(jobs.pool);
+
+  ctx->diagnostic_gate = NULL;
+  ctx->diagnostic_gate_data = NULL;
+  struct BodyJob* job = jobs.head;
+  while(job) {
+    Arena_adopt(&ctx->ast_arena, &job->arena);
+    struct BodyJob* next = job->next;
+    free(job);
+    job = next;
+  }
+  cnd_destroy(&jobs.progress);
+  mtx_destroy(&jobs.lock);
+}
+
 void scope_resolve(struct Context* ctx) {
+  // the scopes live as long as the AST they are stored on
+  scope_arena = &ctx->ast_arena;
   struct AstNode* body = ctx->ast;
   struct ScopeResult* scope = allocate_ScopeResult(ctx, body, NULL);
 
   install_builtins(ctx, scope);
 
-  ast_foreach(ast_Block_stmts(body), s) {
-    scope_resolve_internal(ctx, scope, s);
+  if(Arguments_numThreads(ctx->arguments) > 1) {
+    scope_resolve_parallel(ctx, scope);
+  } else {
+    ast_foreach(ast_Block_stmts(body), s) {
+      scope_resolve_internal(ctx, scope, s);
+    }
+  }
+  scope_arena = NULL;
+}
+
+static void scope_deinit_ast(struct AstNode* ast) {
+  LL_FOREACH(ast, a) {
+    if(ast_is_type(a, ast_Block) && ast_Block_scope(a)) {
+      struct ScopeResult* sr = ast_Block_scope(a);
+      LL_FOREACH(sr->symbols, ss) {
+        if(ss->sst != sst_Type) continue;
+        if(Type_is_typedef(ss->ss_type)) Type_free_fields(ss->ss_type);
+        Type_free_ptr_types(ss->ss_type);
+      }
+      HashMap_deinit(&sr->symbols_by_name);
+    }
+    for(int i = 0; i < ast_num_children(a); i++) {
+      struct AstNode* child = ast_get_child(a, i);
+      if(child) scope_deinit_ast(child);
+    }
   }
 }
+void scope_deinit(struct Context* ctx) {
+  if(!ctx->scope_table) return;
+  scope_deinit_ast(ctx->ast);
+  ctx->scope_table = NULL;
+}
 struct ScopeSymbol* scope_lookup_name(
-    struct Context* ctx,
+    __attribute__((unused)) struct Context* ctx,
     struct ScopeResult* sr,
     char* name,
     int search_parent) {
-
-  LL_FOREACH(sr->symbols, sym) {
-    if(strcmp(ScopeSymbol_name(sym), name) == 0) {
-      return sym;
-    }
-  }
-  if(search_parent && sr->parent_scope) {
-    return scope_lookup_name(ctx, sr->parent_scope, name, search_parent);
-  }
-
-  return NULL;
+  return scope_lookup_interned(sr, intern(name), search_parent);
 }
 
 struct ScopeSymbol* scope_lookup_typename(
-    struct Context* ctx,
+    __attribute__((unused)) struct Context* ctx,
     struct ScopeResult* sr,
     struct AstNode* typename,
     int search_parent) {
   ASSERT(ast_is_type(typename, ast_Typename));
   // lookup the name, then make a ptr as needed
   char* name = ast_Typename_name(typename);
-  struct ScopeSymbol* base_ss = scope_lookup_name(ctx, sr, name, search_parent);
+  struct ScopeSymbol* base_ss = scope_lookup_interned(sr, name, search_parent);
   if(!base_ss || base_ss->sst != sst_Type) {
     return NULL;
   }
@@ -507,8 +698,7 @@ struct ScopeSymbol* scope_lookup_typename(
     ptr_level--;
   }
   // dont store the ptr in the symbols
-  struct ScopeSymbol* ss = ScopeSymbol_init_type(ptr_type);
-  return ss;
+  return ScopeSymbol_init_type(ptr_type);
 }
 
 struct Type* scope_get_Type_from_name(
@@ -701,7 +891,7 @@ static struct Type* scope_get_Type_from_uop(
       ast_to_string(expr));
 }
 
-struct Type* scope_get_Type_from_ast(
+static struct Type* compute_Type_from_ast(
     struct Context* ctx,
     struct ScopeResult* sr,
     struct AstNode* ast,
@@ -719,7 +909,7 @@ struct Type* scope_get_Type_from_ast(
     return sym->ss_type;
   } else if(ast_is_type(ast, ast_Identifier)) {
     char* name = ast_Identifier_name(ast);
-    struct ScopeSymbol* sym = scope_lookup_name(ctx, sr, name, search_parent);
+    struct ScopeSymbol* sym = scope_lookup_interned(sr, name, search_parent);
     if(sym && sym->sst == sst_Type) {
       return sym->ss_type;
     } else if(sym && sym->sst == sst_Variable) {
@@ -758,7 +948,7 @@ struct Type* scope_get_Type_from_ast(
   } else if(ast_is_type(ast, ast_Call)) {
     // get the return type of the function we are calling
     char* name = ast_Identifier_name(ast_Call_name(ast));
-    struct ScopeSymbol* sym = scope_lookup_name(ctx, sr, name, search_parent);
+    struct ScopeSymbol* sym = scope_lookup_interned(sr, name, search_parent);
     if(sym && sym->sst == sst_Function) {
       return sym->ss_function->rettype;
     } else if(sym && ScopeSymbol_isBuiltin(sym)) {
@@ -797,8 +987,24 @@ struct Type* scope_get_Type_from_ast(
     struct TypeField* fieldType = Type_get_TypeField(
         objectType,
         ast_Identifier_name(ast_FieldAccess_field(ast)));
+    if(!fieldType) {
+      ERROR_ON_AST(ctx, ast, "unknown field name\n");
+    }
     return fieldType->type;
   } else {
     UNIMPLEMENTED("getting type from ast\n");
   }
 }
+
+// an expression is typed once, scope resolution and codegen share the result
+struct Type* scope_get_Type_from_ast(
+    struct Context* ctx,
+    struct ScopeResult* sr,
+    struct AstNode* ast,
+    int search_parent) {
+  struct Type* type = ast_resolved_type(ast);
+  if(type) return type;
+  type = compute_Type_from_ast(ctx, sr, ast, search_parent);
+  ast_set_resolved_type(ast, type);
+  return type;
+}
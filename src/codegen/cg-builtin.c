@@ -45,10 +45,10 @@ static struct cg_value* codegenBuiltin_codegenBuiltinSizeof(
 
   LLVMTypeRef cg_type = LLVMInt64TypeInContext(ctx->codegen->llvmContext);
   LLVMValueRef val = LLVMConstPtrToInt(gep, cg_type);
-  return allocate_stack_for_temp(
+  return add_temp_value(
       ctx,
-      cg_type,
       val,
+      cg_type,
       scope_get_Type_from_name(ctx, scope, "int", 1));
 }
 
@@ -71,12 +71,7 @@ static struct cg_value* codegenBuiltin_codegenBuiltinTypeof(
 
   char* typename = Type_to_string(type);
 
-  struct cg_value* str_lit = get_string_literal(ctx, scope, typename);
-  return allocate_stack_for_temp(
-      ctx,
-      str_lit->cg_type,
-      str_lit->value,
-      str_lit->type);
+  return get_string_literal(ctx, scope, typename);
 }
 
 static struct cg_value* codegenBuiltin_codegenBuiltinAssert(
@@ -105,8 +100,7 @@ static struct cg_value* codegenBuiltin_codegenBuiltinAssert(
       LLVMCreateBasicBlockInContext(ctx->codegen->llvmContext, "");
 
   struct cg_value* expr = codegen_expr(ctx, arg, scope);
-  LLVMValueRef exprVal =
-      LLVMBuildLoad2(ctx->codegen->builder, expr->cg_type, expr->value, "");
+  LLVMValueRef exprVal = load_value(ctx, expr);
 
   LLVMValueRef cond = LLVMBuildICmp(
       ctx->codegen->builder,
@@ -146,11 +140,7 @@ static struct cg_value* codegenBuiltin_codegenBuiltinAssert(
   // return poison
   LLVMTypeRef poisonType =
       LLVMPointerTypeInContext(ctx->codegen->llvmContext, 0);
-  return allocate_stack_for_temp(
-      ctx,
-      poisonType,
-      LLVMGetPoison(poisonType),
-      NULL);
+  return add_temp_value(ctx, LLVMGetPoison(poisonType), poisonType, NULL);
 }
 
 static int validArgumentToNew(struct AstNode* arg) { return arg != NULL; }
@@ -183,7 +173,7 @@ static struct cg_value* codegenBuiltin_codegenBuiltinNew(
   LLVMValueRef val = LLVMBuildMalloc(ctx->codegen->builder, cg_type, "new");
   ASSERT(LLVMGetTypeKind(cg_newType) == LLVMGetTypeKind(LLVMTypeOf(val)));
 
-  return allocate_stack_for_temp(ctx, cg_newType, val, newType);
+  return add_temp_value(ctx, val, cg_newType, newType);
 }
 
 struct cg_value* codegenBuiltin(
@@ -194,11 +184,12 @@ struct cg_value* codegenBuiltin(
   ASSERT(ScopeSymbol_isBuiltin(symBuiltin));
   struct CompilerBuiltin* builtin = symBuiltin->ss_builtin;
 
+  switch(builtin->kind) {
 #define BUILTIN_FUNCTION(name_, numArgs_, resType_, codegenFunc)               \
-  if(strcmp(#name_, builtin->name) == 0 && numArgs_ == builtin->num_args) {    \
-    return codegenBuiltin_##codegenFunc(ctx, scope, builtin, call);            \
-  }
+  case cb_##codegenFunc:                                                       \
+    return codegenBuiltin_##codegenFunc(ctx, scope, builtin, call);
 #include "definitions/builtins.def"
+  }
 
   return NULL;
 }
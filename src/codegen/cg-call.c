@@ -49,8 +49,7 @@ codegen_call(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
   LLVMValueRef* args = malloc(sizeof(*args) * numArgs);
   ast_foreach_idx(ast_Call_args(ast), a, i) {
     struct cg_value* val = codegen_inst(ctx, a, sr);
-    args[i] =
-        LLVMBuildLoad2(ctx->codegen->builder, val->cg_type, val->value, "");
+    args[i] = load_value(ctx, val);
   }
   LLVMValueRef call = LLVMBuildCall2(
       ctx->codegen->builder,
@@ -80,18 +79,14 @@ codegen_call(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
 
   LLVMTypeRef rettype = LLVMGetReturnType(func->cg_type);
   if(LLVMGetTypeKind(rettype) != LLVMVoidTypeKind) {
-    return allocate_stack_for_temp(
-        ctx,
-        LLVMGetReturnType(func->cg_type),
-        call,
-        func->rettype);
+    return add_temp_value(ctx, call, rettype, func->rettype);
   } else {
     LLVMTypeRef poisonType =
         LLVMPointerTypeInContext(ctx->codegen->llvmContext, 0);
-    return allocate_stack_for_temp(
+    return add_temp_value(
         ctx,
-        poisonType,
         LLVMGetPoison(poisonType),
+        poisonType,
         func->rettype);
   }
 }
@@ -184,6 +184,9 @@ struct cg_value* codegen_function(
           ctx->codegen->debugBuilder,
           func->di->subprogram);
     }
+
+    // the locals are not visible outside the function
+    HashMap_deinit(&ctx->codegen->local_values);
   }
 
   return add_temp_value(ctx, func->function, func->cg_type, func->rettype);
@@ -6,20 +6,20 @@
 #include "ast/ast.h"
 #include "ast/scope-resolve.h"
 #include "common/bsstring.h"
+#include "common/intern.h"
 
 #include <string.h>
 
 struct cg_value* get_value(struct Context* ctx, struct ScopeSymbol* ss) {
-  LL_FOREACH(ctx->codegen->current_values, v) {
-    if(v->variable && ScopeSymbol_eq(v->variable, ss)) {
-      return v;
-    }
-  }
-  // no value
-  return NULL;
+  if(ss->sst != sst_Variable) return NULL;
+  struct AstNode* variable = ss->ss_variable->variable;
+  struct cg_value* val = HashMap_get(&ctx->codegen->local_values, variable);
+  if(val) return val;
+  return HashMap_get(&ctx->codegen->global_values, variable);
 }
+// temporaries are never looked up, so they are not recorded anywhere
 struct cg_value* add_temp_value(
-    struct Context* ctx,
+    __attribute__((unused)) struct Context* ctx,
     LLVMValueRef value,
     LLVMTypeRef cg_type,
     struct Type* type) {
@@ -28,10 +28,9 @@ struct cg_value* add_temp_value(
   val->value = value;
   val->cg_type = cg_type;
   val->type = type;
-  LL_APPEND(ctx->codegen->current_values, val);
   return val;
 }
-struct cg_value* add_value(
+static struct cg_value* build_value(
     struct Context* ctx,
     LLVMValueRef value,
     LLVMTypeRef cg_type,
@@ -40,16 +39,30 @@ struct cg_value* add_value(
   struct cg_value* val =
       add_temp_value(ctx, value, cg_type, ss->ss_variable->type);
   val->variable = ss;
+  val->is_lvalue = 1;
+  return val;
+}
+struct cg_value* add_value(
+    struct Context* ctx,
+    LLVMValueRef value,
+    LLVMTypeRef cg_type,
+    struct ScopeSymbol* ss) {
+  struct cg_value* val = build_value(ctx, value, cg_type, ss);
+  HashMap_put_new(&ctx->codegen->local_values, ss->ss_variable->variable, val);
+  return val;
+}
+struct cg_value* add_global_value(
+    struct Context* ctx,
+    LLVMValueRef value,
+    LLVMTypeRef cg_type,
+    struct ScopeSymbol* ss) {
+  struct cg_value* val = build_value(ctx, value, cg_type, ss);
+  HashMap_put_new(&ctx->codegen->global_values, ss->ss_variable->variable, val);
   return val;
 }
 
 struct cg_function* get_function_named(struct Context* ctx, char* mname) {
-  LL_FOREACH(ctx->codegen->functions, f) {
-    if(strcmp(f->mname, mname) == 0) {
-      return f;
-    }
-  }
-  return NULL;
+  return HashMap_get(&ctx->codegen->functions_by_name, intern(mname));
 }
 struct cg_function* add_function(
     struct Context* ctx,
@@ -60,12 +73,13 @@ struct cg_function* add_function(
     struct Type* rettype) {
   struct cg_function* f = malloc(sizeof(*f));
   memset(f, 0, sizeof(*f));
-  f->name = bsstrdup(name);
-  f->mname = bsstrdup(mname);
+  f->name = intern(name);
+  f->mname = intern(mname);
   f->function = func;
   f->cg_type = cg_type;
   f->rettype = rettype;
-  LL_APPEND(ctx->codegen->functions, f);
+  LL_APPEND_TAIL(ctx->codegen->functions, ctx->codegen->functions_tail, f);
+  HashMap_put_new(&ctx->codegen->functions_by_name, f->mname, f);
   return f;
 }
 
@@ -323,9 +337,10 @@ get_string_literal(struct Context* ctx, struct ScopeResult* scope, char* str) {
       scope_get_Type_from_name(ctx, scope, "string", 1));
 }
 
-LLVMTypeRef
-get_llvm_type(struct Context* ctx, struct ScopeResult* scope, struct Type* tt) {
-  tt = Type_get_base_type(tt);
+static LLVMTypeRef lower_type(
+    struct Context* ctx,
+    struct ScopeResult* scope,
+    struct Type* tt) {
   if(tt->kind == tk_BUILTIN) {
 
     // special case for 'void'
@@ -338,17 +353,19 @@ get_llvm_type(struct Context* ctx, struct ScopeResult* scope, struct Type* tt) {
   } else if(tt->kind == tk_POINTER) {
     return LLVMPointerTypeInContext(ctx->codegen->llvmContext, 0);
   } else if(tt->kind == tk_TYPEDEF) {
+    // llvm renames the struct if another type already has this name, so
+    // same named types from different scopes stay distinct
+    LLVMTypeRef llvmTT =
+        LLVMStructCreateNamed(ctx->codegen->llvmContext, tt->name);
+    // cache before lowering the fields so a field can refer back to it
+    HashMap_put(&ctx->codegen->llvm_types, tt, llvmTT);
     int n_fields = Type_get_num_fields(tt);
     LLVMTypeRef* fields = malloc(sizeof(*fields) * n_fields);
-    LL_FOREACH_ENUMERATE(tt->fields, f, i) {
-      fields[i] = get_llvm_type(ctx, scope, f->type);
-    }
-    LLVMTypeRef llvmTT =
-        LLVMGetTypeByName2(ctx->codegen->llvmContext, tt->name);
-    if(!llvmTT) {
-      llvmTT = LLVMStructCreateNamed(ctx->codegen->llvmContext, tt->name);
-      LLVMStructSetBody(llvmTT, fields, n_fields, 0);
+    for(int i = 0; i < n_fields; i++) {
+      fields[i] = get_llvm_type(ctx, scope, tt->field_array[i]->type);
     }
+    LLVMStructSetBody(llvmTT, fields, n_fields, 0);
+    free(fields);
     return llvmTT;
   } else if(tt->kind == tk_OPAQUE) {
     ERROR(ctx, "unknown type definition for '%s', type is opaque\n", tt->name);
@@ -357,6 +374,17 @@ get_llvm_type(struct Context* ctx, struct ScopeResult* scope, struct Type* tt) {
   }
 }
 
+// each type is lowered once, keyed by its canonical type so aliases share it
+LLVMTypeRef
+get_llvm_type(struct Context* ctx, struct ScopeResult* scope, struct Type* tt) {
+  tt = Type_canonical(tt);
+  LLVMTypeRef llvmTT = HashMap_get(&ctx->codegen->llvm_types, tt);
+  if(llvmTT) return llvmTT;
+  llvmTT = lower_type(ctx, scope, tt);
+  HashMap_put(&ctx->codegen->llvm_types, tt, llvmTT);
+  return llvmTT;
+}
+
 LLVMTypeRef get_llvm_type_ast(
     struct Context* ctx,
     struct ScopeResult* scope,
@@ -375,14 +403,11 @@ LLVMTypeRef get_llvm_type_sym(
   return llvmTT;
 }
 
-static struct cg_value* allocate_stack_helper(
+static LLVMValueRef build_entry_alloca(
     struct Context* ctx,
     LLVMTypeRef cg_type,
     LLVMValueRef initial,
-    struct ScopeSymbol* sym,
-    struct Type* type) {
-  // sym can be NULL, or it must be a variable
-  ASSERT(!sym || sym->sst == sst_Variable);
+    char* name) {
   // allocate a variable, make sure to switch the entry
   LLVMBasicBlockRef previousBB = LLVMGetInsertBlock(ctx->codegen->builder);
   LLVMBasicBlockRef entryBB =
@@ -391,22 +416,14 @@ static struct cg_value* allocate_stack_helper(
   if(firstInst) LLVMPositionBuilderBefore(ctx->codegen->builder, firstInst);
   else LLVMPositionBuilderAtEnd(ctx->codegen->builder, entryBB);
 
-  char* name =
-      sym ? ast_Identifier_name(ast_Variable_name(sym->ss_variable->variable))
-          : "temp";
-
-  // get the alloca, add as a value
   LLVMValueRef stack_ptr =
       LLVMBuildAlloca(ctx->codegen->builder, cg_type, name);
-  struct cg_value* val;
-  if(sym) val = add_value(ctx, stack_ptr, cg_type, sym);
-  else val = add_temp_value(ctx, stack_ptr, cg_type, type);
 
   // go back to bb
   LLVMPositionBuilderAtEnd(ctx->codegen->builder, previousBB);
   // set initial value
   LLVMBuildStore(ctx->codegen->builder, initial, stack_ptr);
-  return val;
+  return stack_ptr;
 }
 
 struct cg_value* allocate_stack_for_sym(
@@ -415,17 +432,17 @@ struct cg_value* allocate_stack_for_sym(
     LLVMValueRef initial,
     struct ScopeSymbol* sym) {
   ASSERT(sym->sst == sst_Variable);
-  return allocate_stack_helper(
-      ctx,
-      cg_type,
-      initial,
-      sym,
-      sym->ss_variable->type);
+  char* name =
+      ast_Identifier_name(ast_Variable_name(sym->ss_variable->variable));
+  LLVMValueRef stack_ptr = build_entry_alloca(ctx, cg_type, initial, name);
+  return add_value(ctx, stack_ptr, cg_type, sym);
 }
-struct cg_value* allocate_stack_for_temp(
-    struct Context* ctx,
-    LLVMTypeRef cg_type,
-    LLVMValueRef initial,
-    struct Type* type) {
-  return allocate_stack_helper(ctx, cg_type, initial, NULL, type);
+
+LLVMValueRef load_value(struct Context* ctx, struct cg_value* val) {
+  if(!val->is_lvalue) return val->value;
+  return LLVMBuildLoad2(ctx->codegen->builder, val->cg_type, val->value, "");
+}
+LLVMValueRef get_address(struct Context* ctx, struct cg_value* val) {
+  if(val->is_lvalue) return val->value;
+  return build_entry_alloca(ctx, val->cg_type, val->value, "temp");
 }
@@ -6,16 +6,23 @@
 #include <wchar.h>
 
 struct cg_value* get_value(struct Context* ctx, struct ScopeSymbol* ss);
+// an r-value
 struct cg_value* add_temp_value(
     struct Context* ctx,
     LLVMValueRef value,
     LLVMTypeRef cg_type,
     struct Type* type);
+// a local of the function being generated
 struct cg_value* add_value(
     struct Context* ctx,
     LLVMValueRef value,
     LLVMTypeRef cg_type,
     struct ScopeSymbol* ss);
+struct cg_value* add_global_value(
+    struct Context* ctx,
+    LLVMValueRef value,
+    LLVMTypeRef cg_type,
+    struct ScopeSymbol* ss);
 
 struct cg_function* get_function_named(struct Context* ctx, char* name);
 struct cg_function* add_function(
@@ -72,10 +79,9 @@ struct cg_value* allocate_stack_for_sym(
     LLVMTypeRef cg_type,
     LLVMValueRef initial,
     struct ScopeSymbol* sym);
-struct cg_value* allocate_stack_for_temp(
-    struct Context* ctx,
-    LLVMTypeRef cg_type,
-    LLVMValueRef initial,
-    struct Type* type);
+// the value itself, loading it if `val` is an l-value
+LLVMValueRef load_value(struct Context* ctx, struct cg_value* val);
+// the address of the value, r-values are spilled to the stack
+LLVMValueRef get_address(struct Context* ctx, struct cg_value* val);
 
 #endif
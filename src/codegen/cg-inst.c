@@ -23,15 +23,16 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
     struct cg_value* lhs = codegen_inst(ctx, ast_Assignment_lhs(ast), sr);
     struct cg_value* rhs = codegen_inst(ctx, ast_Assignment_expr(ast), sr);
 
-    LLVMValueRef rhsVal =
-        LLVMBuildLoad2(ctx->codegen->builder, rhs->cg_type, rhs->value, "");
+    LLVMValueRef rhsVal = load_value(ctx, rhs);
 
     LLVMValueRef ptrToStoreTo;
     if(!ast_Assignment_is_ptr_access(ast)) {
+      if(!lhs->is_lvalue) {
+        ERROR_ON_AST(ctx, ast, "cannot assign to a temporary value\n");
+      }
       ptrToStoreTo = lhs->value;
     } else {
-      ptrToStoreTo =
-          LLVMBuildLoad2(ctx->codegen->builder, lhs->cg_type, lhs->value, "");
+      ptrToStoreTo = load_value(ctx, lhs);
     }
 
     ASSERT(LLVMGetTypeKind(LLVMTypeOf(ptrToStoreTo)) == LLVMPointerTypeKind);
@@ -41,50 +42,37 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
 
   } else if(ast_is_type(ast, ast_FieldAccess)) {
 
+    // scope resolution checks the access when it types it
+    struct Type* resType = scope_get_Type_from_ast(ctx, sr, ast, 1);
     struct cg_value* object =
         codegen_inst(ctx, ast_FieldAccess_object(ast), sr);
 
-    // TODO: much of this logic is now duplicated during scope resolution, we
-    // should be able to just  call scope resolve to get types
-
     struct Type* objectType = Type_get_base_type(object->type);
-    struct Type* objectPtrType = NULL;
-    if(Type_is_pointer(objectType)) {
-      objectPtrType = objectType;
-      objectType = Type_get_pointee_type(objectPtrType);
-    }
+    int objectIsPtr = Type_is_pointer(objectType);
+    if(objectIsPtr) objectType = Type_get_pointee_type(objectType);
 
-    // check types
-    if(objectPtrType && !Type_is_pointer(objectPtrType)) {
-      ERROR_ON_AST(
-          ctx,
-          ast,
-          "invalid field access - cannot use '->' on a non-pointer\n");
-    }
-    if(objectType && !Type_is_typedef(objectType)) {
-      ERROR_ON_AST(
-          ctx,
-          ast,
-          "invalid field access - base is not a struct-like type\n");
-    }
-
-    // compute the offset into the object
+    // the field is only needed for its index
     struct TypeField* fieldType = Type_get_TypeField(
         objectType,
         ast_Identifier_name(ast_FieldAccess_field(ast)));
-    if(!fieldType) {
-      ERROR_ON_AST(ctx, ast, "unknown field name\n");
-    }
+    ASSERT(fieldType && fieldType->type == resType);
     int fieldIdx = TypeField_get_index(fieldType);
+    LLVMTypeRef fieldLLVMType = get_llvm_type(ctx, sr, resType);
 
-    LLVMValueRef ptrForGep;
-    if(objectPtrType) {
-      // load the ptr
-      ptrForGep = LLVMBuildLoad2(
+    // the field of a struct r-value is an r-value too, read it directly
+    if(!objectIsPtr && !object->is_lvalue) {
+      LLVMValueRef fieldVal = LLVMBuildExtractValue(
           ctx->codegen->builder,
-          object->cg_type,
           object->value,
+          fieldIdx,
           "");
+      return add_temp_value(ctx, fieldVal, fieldLLVMType, resType);
+    }
+
+    LLVMValueRef ptrForGep;
+    if(objectIsPtr) {
+      // load the ptr
+      ptrForGep = load_value(ctx, object);
     } else {
       ptrForGep = object->value;
     }
@@ -100,11 +88,8 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
     LLVMValueRef gep =
         LLVMBuildGEP2(ctx->codegen->builder, gepType, ptrForGep, gepIdx, 2, "");
 
-    struct cg_value* ret = add_temp_value(
-        ctx,
-        gep,
-        get_llvm_type(ctx, sr, fieldType->type),
-        fieldType->type);
+    struct cg_value* ret = add_temp_value(ctx, gep, fieldLLVMType, resType);
+    ret->is_lvalue = 1;
 
     return ret;
 
@@ -129,12 +114,7 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
     return val;
 
   } else if(ast_is_constant(ast)) {
-    struct cg_value* constant = codegen_constant_expr(ctx, ast, sr);
-    return allocate_stack_for_temp(
-        ctx,
-        constant->cg_type,
-        constant->value,
-        constant->type);
+    return codegen_constant_expr(ctx, ast, sr);
   } else if(ast_is_type(ast, ast_Call)) {
     return codegen_call(ctx, ast, sr);
   } else if(ast_is_type(ast, ast_Return)) {
@@ -142,12 +122,8 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
     if(ast_Return_expr(ast)) {
 
       struct cg_value* expr = codegen_inst(ctx, ast_Return_expr(ast), sr);
-      ASSERT_MSG(
-          LLVMGetTypeKind(LLVMTypeOf(expr->value)) == LLVMPointerTypeKind,
-          "cannot load a non-pointer value\n");
       // load the expr and return it
-      LLVMValueRef load =
-          LLVMBuildLoad2(ctx->codegen->builder, expr->cg_type, expr->value, "");
+      LLVMValueRef load = load_value(ctx, expr);
       LLVMValueRef ret = LLVMBuildRet(ctx->codegen->builder, load);
       return add_temp_value(
           ctx,
@@ -178,8 +154,7 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
     // get the expr and build branch
     struct cg_value* expr =
         codegen_inst(ctx, ast_Conditional_condition(ast), sr);
-    LLVMValueRef exprVal =
-        LLVMBuildLoad2(ctx->codegen->builder, expr->cg_type, expr->value, "");
+    LLVMValueRef exprVal = load_value(ctx, expr);
     LLVMValueRef cond = LLVMBuildICmp(
         ctx->codegen->builder,
         LLVMIntNE,
@@ -256,8 +231,7 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
 
     // get the expr and build branch
     struct cg_value* expr = codegen_inst(ctx, ast_While_condition(ast), sr);
-    LLVMValueRef exprVal =
-        LLVMBuildLoad2(ctx->codegen->builder, expr->cg_type, expr->value, "");
+    LLVMValueRef exprVal = load_value(ctx, expr);
     LLVMValueRef cond = LLVMBuildICmp(
         ctx->codegen->builder,
         LLVMIntNE,
@@ -326,7 +300,7 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
               "expression\n");
         }
       }
-      struct cg_value* value = add_value(ctx, global, cg_type, sym);
+      struct cg_value* value = add_global_value(ctx, global, cg_type, sym);
       return value;
 
     } else {
@@ -346,15 +320,7 @@ codegen_inst(struct Context* ctx, struct AstNode* ast, struct ScopeResult* sr) {
         if(init_expr) {
           struct cg_value* init_val = codegen_inst(ctx, init_expr, sr);
           // load the init value, store it to the new variable
-          ASSERT_MSG(
-              LLVMGetTypeKind(LLVMTypeOf(init_val->value)) ==
-                  LLVMPointerTypeKind,
-              "cannot load a non-pointer value\n");
-          LLVMValueRef load = LLVMBuildLoad2(
-              ctx->codegen->builder,
-              init_val->cg_type,
-              init_val->value,
-              "");
+          LLVMValueRef load = load_value(ctx, init_val);
           val = allocate_stack_for_sym(ctx, cg_type, load, sym);
         } else {
           val =
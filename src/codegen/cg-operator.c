@@ -19,10 +19,8 @@ static struct cg_value* codegenOperator_sintBOp(
       Type_is_signed(lhs->type) && Type_is_signed(rhs->type) &&
       Type_is_signed(resType) && Type_eq(lhs->type, rhs->type));
 
-  LLVMValueRef lhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, lhs->cg_type, lhs->value, "");
-  LLVMValueRef rhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, rhs->cg_type, rhs->value, "");
+  LLVMValueRef lhsVal = load_value(ctx, lhs);
+  LLVMValueRef rhsVal = load_value(ctx, rhs);
 
   LLVMValueRef resVal;
   if(op == op_PLUS) {
@@ -50,7 +48,7 @@ static struct cg_value* codegenOperator_sintBOp(
   }
 
   struct cg_value* res =
-      allocate_stack_for_temp(ctx, resLLVMType, resVal, resType);
+      add_temp_value(ctx, resVal, resLLVMType, resType);
   return res;
 }
 
@@ -66,11 +64,7 @@ static struct cg_value* codegenOperator_intNegate(
       Type_eq(operand->type, resType));
   ASSERT(op == op_MINUS);
 
-  LLVMValueRef operandVal = LLVMBuildLoad2(
-      ctx->codegen->builder,
-      operand->cg_type,
-      operand->value,
-      "");
+  LLVMValueRef operandVal = load_value(ctx, operand);
 
   LLVMValueRef resVal = LLVMBuildSub(
       ctx->codegen->builder,
@@ -85,7 +79,7 @@ static struct cg_value* codegenOperator_intNegate(
   }
 
   struct cg_value* res =
-      allocate_stack_for_temp(ctx, resLLVMType, resVal, resType);
+      add_temp_value(ctx, resVal, resLLVMType, resType);
   return res;
 }
 
@@ -99,10 +93,8 @@ static struct cg_value* codegenOperator_compare(
   struct cg_value* lhs = codegen_inst(ctx, lhsAst, scope);
   struct cg_value* rhs = codegen_inst(ctx, rhsAst, scope);
 
-  LLVMValueRef lhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, lhs->cg_type, lhs->value, "");
-  LLVMValueRef rhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, rhs->cg_type, rhs->value, "");
+  LLVMValueRef lhsVal = load_value(ctx, lhs);
+  LLVMValueRef rhsVal = load_value(ctx, rhs);
 
   // if they are both ptrs, no need to change anything.
   // if one or the other is a ptr, need to do 'ptrtoint'
@@ -140,7 +132,7 @@ static struct cg_value* codegenOperator_compare(
   ASSERT(LLVMGetTypeKind(LLVMTypeOf(resVal)) == LLVMGetTypeKind(resLLVMType));
 
   struct cg_value* res =
-      allocate_stack_for_temp(ctx, resLLVMType, resVal, resType);
+      add_temp_value(ctx, resVal, resLLVMType, resType);
   return res;
 }
 
@@ -155,12 +147,6 @@ static struct cg_value* codegenOperator_booleanAnd(
   ASSERT(Type_is_boolean(resType));
   LLVMTypeRef resLLVMType = get_llvm_type(ctx, scope, resType);
 
-  struct cg_value* res = allocate_stack_for_temp(
-      ctx,
-      resLLVMType,
-      LLVMConstInt(resLLVMType, 0, 0),
-      resType);
-
   // this works by creating two branches. We always eval the lhs. if its true,
   // we have to eval the rhs. If the lhs is false, no need to eval the rhs
   // (shortcircuit) this is easy to do with branching
@@ -174,22 +160,22 @@ static struct cg_value* codegenOperator_booleanAnd(
       LLVMCreateBasicBlockInContext(ctx->codegen->llvmContext, "and.end");
 
   struct cg_value* lhs = codegen_inst(ctx, lhsAst, scope);
-  LLVMValueRef lhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, lhs->cg_type, lhs->value, "");
+  LLVMValueRef lhsVal = load_value(ctx, lhs);
   LLVMValueRef lhsCond = LLVMBuildICmp(
       ctx->codegen->builder,
       LLVMIntNE,
       lhsVal,
       LLVMConstNull(LLVMTypeOf(lhsVal)),
       "");
+  // the lhs may have added blocks, branch from wherever it ended
+  LLVMBasicBlockRef lhsEndBB = LLVMGetInsertBlock(ctx->codegen->builder);
   LLVMBuildCondBr(ctx->codegen->builder, lhsCond, rhsBB, endBB);
 
   LLVMAppendExistingBasicBlock(currentFunc, rhsBB);
   LLVMPositionBuilderAtEnd(ctx->codegen->builder, rhsBB);
 
   struct cg_value* rhs = codegen_inst(ctx, rhsAst, scope);
-  LLVMValueRef rhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, rhs->cg_type, rhs->value, "");
+  LLVMValueRef rhsVal = load_value(ctx, rhs);
   LLVMValueRef rhsCond = LLVMBuildICmp(
       ctx->codegen->builder,
       LLVMIntNE,
@@ -197,14 +183,19 @@ static struct cg_value* codegenOperator_booleanAnd(
       LLVMConstNull(LLVMTypeOf(rhsVal)),
       "");
   ASSERT(LLVMGetTypeKind(resLLVMType) == LLVMGetTypeKind(LLVMTypeOf(rhsCond)));
-  LLVMBuildStore(ctx->codegen->builder, rhsCond, res->value);
+  LLVMBasicBlockRef rhsEndBB = LLVMGetInsertBlock(ctx->codegen->builder);
   LLVMBuildBr(ctx->codegen->builder, endBB);
 
   // move to end and keep going
   LLVMAppendExistingBasicBlock(currentFunc, endBB);
   LLVMPositionBuilderAtEnd(ctx->codegen->builder, endBB);
 
-  return res;
+  // short circuiting from the lhs gives false
+  LLVMValueRef resVal = LLVMBuildPhi(ctx->codegen->builder, resLLVMType, "");
+  LLVMValueRef incomingVals[] = {LLVMConstInt(resLLVMType, 0, 0), rhsCond};
+  LLVMBasicBlockRef incomingBBs[] = {lhsEndBB, rhsEndBB};
+  LLVMAddIncoming(resVal, incomingVals, incomingBBs, 2);
+  return add_temp_value(ctx, resVal, resLLVMType, resType);
 }
 
 static struct cg_value* codegenOperator_booleanOr(
@@ -218,12 +209,6 @@ static struct cg_value* codegenOperator_booleanOr(
   ASSERT(Type_is_boolean(resType));
   LLVMTypeRef resLLVMType = get_llvm_type(ctx, scope, resType);
 
-  struct cg_value* res = allocate_stack_for_temp(
-      ctx,
-      resLLVMType,
-      LLVMConstInt(resLLVMType, 1, 0),
-      resType);
-
   // this works by creating two branches. We always eval the lhs. if its false,
   // we have to eval the rhs. If the lhs is true, no need to eval the rhs
   // (shortcircuit). this is easy to do with branching
@@ -237,22 +222,22 @@ static struct cg_value* codegenOperator_booleanOr(
       LLVMCreateBasicBlockInContext(ctx->codegen->llvmContext, "or.end");
 
   struct cg_value* lhs = codegen_inst(ctx, lhsAst, scope);
-  LLVMValueRef lhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, lhs->cg_type, lhs->value, "");
+  LLVMValueRef lhsVal = load_value(ctx, lhs);
   LLVMValueRef lhsCond = LLVMBuildICmp(
       ctx->codegen->builder,
       LLVMIntNE,
       lhsVal,
       LLVMConstNull(LLVMTypeOf(lhsVal)),
       "");
+  // the lhs may have added blocks, branch from wherever it ended
+  LLVMBasicBlockRef lhsEndBB = LLVMGetInsertBlock(ctx->codegen->builder);
   LLVMBuildCondBr(ctx->codegen->builder, lhsCond, endBB, rhsBB);
 
   LLVMAppendExistingBasicBlock(currentFunc, rhsBB);
   LLVMPositionBuilderAtEnd(ctx->codegen->builder, rhsBB);
 
   struct cg_value* rhs = codegen_inst(ctx, rhsAst, scope);
-  LLVMValueRef rhsVal =
-      LLVMBuildLoad2(ctx->codegen->builder, rhs->cg_type, rhs->value, "");
+  LLVMValueRef rhsVal = load_value(ctx, rhs);
   LLVMValueRef rhsCond = LLVMBuildICmp(
       ctx->codegen->builder,
       LLVMIntNE,
@@ -260,14 +245,19 @@ static struct cg_value* codegenOperator_booleanOr(
       LLVMConstNull(LLVMTypeOf(rhsVal)),
       "");
   ASSERT(LLVMGetTypeKind(resLLVMType) == LLVMGetTypeKind(LLVMTypeOf(rhsCond)));
-  LLVMBuildStore(ctx->codegen->builder, rhsCond, res->value);
+  LLVMBasicBlockRef rhsEndBB = LLVMGetInsertBlock(ctx->codegen->builder);
   LLVMBuildBr(ctx->codegen->builder, endBB);
 
   // move to end and keep going
   LLVMAppendExistingBasicBlock(currentFunc, endBB);
   LLVMPositionBuilderAtEnd(ctx->codegen->builder, endBB);
 
-  return res;
+  // short circuiting from the lhs gives true
+  LLVMValueRef resVal = LLVMBuildPhi(ctx->codegen->builder, resLLVMType, "");
+  LLVMValueRef incomingVals[] = {LLVMConstInt(resLLVMType, 1, 0), rhsCond};
+  LLVMBasicBlockRef incomingBBs[] = {lhsEndBB, rhsEndBB};
+  LLVMAddIncoming(resVal, incomingVals, incomingBBs, 2);
+  return add_temp_value(ctx, resVal, resLLVMType, resType);
 }
 
 static struct cg_value* codegenOperator_booleanNot(
@@ -278,11 +268,7 @@ static struct cg_value* codegenOperator_booleanNot(
     struct Type* resType) {
   struct cg_value* operand = codegen_inst(ctx, operandAst, scope);
 
-  LLVMValueRef operandVal = LLVMBuildLoad2(
-      ctx->codegen->builder,
-      operand->cg_type,
-      operand->value,
-      "");
+  LLVMValueRef operandVal = load_value(ctx, operand);
   LLVMValueRef nullVal = LLVMConstNull(LLVMTypeOf(operandVal));
   // !1 -> 1 == 0 -> 0
   // !0 -> 0 == 0 -> 1
@@ -292,7 +278,7 @@ static struct cg_value* codegenOperator_booleanNot(
   ASSERT(LLVMGetTypeKind(LLVMTypeOf(resVal)) == LLVMGetTypeKind(resLLVMType));
 
   struct cg_value* res =
-      allocate_stack_for_temp(ctx, resLLVMType, resVal, resType);
+      add_temp_value(ctx, resVal, resLLVMType, resType);
   return res;
 }
 
@@ -307,19 +293,10 @@ static struct cg_value* codegenOperator_cast(
   struct cg_value* lhsVal = codegen_inst(ctx, lhsAst, scope);
   struct Type* rhsType = scope_get_Type_from_ast(ctx, scope, rhsAst, 1);
   struct Type* lhsType = lhsVal->type;
-  LLVMValueRef val =
-      LLVMBuildLoad2(ctx->codegen->builder, lhsVal->cg_type, lhsVal->value, "");
+  LLVMValueRef val = load_value(ctx, lhsVal);
   struct cg_value* casted = build_cast(ctx, scope, lhsType, val, rhsType);
   // if not casted, unknown cast
-  if(casted) {
-    return allocate_stack_for_temp(
-        ctx,
-        casted->cg_type,
-        casted->value,
-        casted->type);
-  } else {
-    return NULL;
-  }
+  return casted;
 }
 
 static struct cg_value* codegenOperator_addrOffset(
@@ -349,10 +326,8 @@ static struct cg_value* codegenOperator_addrOffset(
     UNIMPLEMENTED("unimplemented op\n");
   }
 
-  LLVMValueRef ptrVal =
-      LLVMBuildLoad2(ctx->codegen->builder, ptr->cg_type, ptr->value, "");
-  LLVMValueRef offsetVal =
-      LLVMBuildLoad2(ctx->codegen->builder, offset->cg_type, offset->value, "");
+  LLVMValueRef ptrVal = load_value(ctx, ptr);
+  LLVMValueRef offsetVal = load_value(ctx, offset);
 
   LLVMTypeRef gepType =
       get_llvm_type(ctx, scope, Type_get_pointee_type(ptrType));
@@ -361,7 +336,7 @@ static struct cg_value* codegenOperator_addrOffset(
       LLVMBuildGEP2(ctx->codegen->builder, gepType, ptrVal, gepIdx, 1, "");
 
   struct cg_value* res =
-      allocate_stack_for_temp(ctx, LLVMTypeOf(resVal), resVal, ptrType);
+      add_temp_value(ctx, resVal, LLVMTypeOf(resVal), ptrType);
   return res;
 }
 
@@ -376,11 +351,7 @@ static struct cg_value* codegenOperator_getValueAtAddress(
 
   struct Type* ptrType = Type_get_base_type(operand->type);
   ASSERT(Type_is_pointer(ptrType));
-  LLVMValueRef ptr = LLVMBuildLoad2(
-      ctx->codegen->builder,
-      operand->cg_type,
-      operand->value,
-      "");
+  LLVMValueRef ptr = load_value(ctx, operand);
   // value should be a pointer, load it, then its pointer
 
   ASSERT(LLVMGetTypeKind(LLVMTypeOf(ptr)) == LLVMPointerTypeKind);
@@ -388,12 +359,11 @@ static struct cg_value* codegenOperator_getValueAtAddress(
       get_llvm_type(ctx, scope, Type_get_pointee_type(ptrType));
   LLVMValueRef loaded =
       LLVMBuildLoad2(ctx->codegen->builder, pointerToLLVMType, ptr, "");
-  struct cg_value* derefed_val = allocate_stack_for_temp(
+  return add_temp_value(
       ctx,
-      pointerToLLVMType,
       loaded,
+      pointerToLLVMType,
       Type_get_pointee_type(ptrType));
-  return derefed_val;
 }
 
 static struct cg_value* codegenOperator_getAddressOfValue(
@@ -405,14 +375,8 @@ static struct cg_value* codegenOperator_getAddressOfValue(
   // just return the stack ptr for this
   struct cg_value* operand = codegen_inst(ctx, operandAst, scope);
   struct Type* operandTypePtr = Type_get_ptr_type(operand->type);
-  ASSERT(LLVMGetTypeKind(LLVMTypeOf(operand->value)) == LLVMPointerTypeKind);
-
-  struct cg_value* address = allocate_stack_for_temp(
-      ctx,
-      LLVMTypeOf(operand->value),
-      operand->value,
-      operandTypePtr);
-  return address;
+  LLVMValueRef address = get_address(ctx, operand);
+  return add_temp_value(ctx, address, LLVMTypeOf(address), operandTypePtr);
 }
 
 static int typesMatch(
@@ -9,7 +9,12 @@
 #include "debug/debugwrappers.h"
 
 #include <llvm-c/Analysis.h>
+#include <llvm-c/BitWriter.h>
 #include <llvm-c/DebugInfo.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/Support.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/Transforms/PassBuilder.h>
 #include <string.h>
 
 #include "cg-helpers.h"
@@ -19,8 +24,19 @@ void init_cg_context(struct Context* ctx) {
   ctx->codegen = malloc(sizeof(*ctx->codegen));
   memset(ctx->codegen, 0, sizeof(*ctx->codegen));
   ctx->codegen->llvmContext = LLVMContextCreate();
+  HashMap_init_pointers(&ctx->codegen->llvm_types);
+  HashMap_init_pointers(&ctx->codegen->global_values);
+  HashMap_init_pointers(&ctx->codegen->local_values);
+  HashMap_init_pointers(&ctx->codegen->functions_by_name);
 }
 void deinit_cg_context(struct Context* ctx) {
+  HashMap_deinit(&ctx->codegen->llvm_types);
+  HashMap_deinit(&ctx->codegen->global_values);
+  HashMap_deinit(&ctx->codegen->local_values);
+  HashMap_deinit(&ctx->codegen->functions_by_name);
+  if(ctx->codegen->targetMachine) {
+    LLVMDisposeTargetMachine(ctx->codegen->targetMachine);
+  }
   LLVMContextDispose(ctx->codegen->llvmContext);
   // TODO
   free(ctx->codegen);
@@ -104,6 +120,34 @@ static void set_linkage(struct Context* ctx) {
   }
 }
 
+static void init_target(struct Context* ctx) {
+  LLVMInitializeNativeTarget();
+  LLVMInitializeNativeAsmPrinter();
+
+  char* triple = LLVMGetDefaultTargetTriple();
+  LLVMTargetRef target;
+  char* errorMsg;
+  if(LLVMGetTargetFromTriple(triple, &target, &errorMsg)) {
+    ERROR(ctx, "unknown target '%s'\n%s\n", triple, errorMsg);
+  }
+  // same defaults the driver used to pass to llc
+  ctx->codegen->targetMachine = LLVMCreateTargetMachine(
+      target,
+      triple,
+      "generic",
+      "",
+      LLVMCodeGenLevelDefault,
+      LLVMRelocPIC,
+      LLVMCodeModelDefault);
+
+  LLVMSetTarget(ctx->codegen->module, triple);
+  LLVMTargetDataRef dataLayout =
+      LLVMCreateTargetDataLayout(ctx->codegen->targetMachine);
+  LLVMSetModuleDataLayout(ctx->codegen->module, dataLayout);
+  LLVMDisposeTargetData(dataLayout);
+  LLVMDisposeMessage(triple);
+}
+
 void codegen(struct Context* ctx) {
 
   // init the module
@@ -111,6 +155,7 @@ void codegen(struct Context* ctx) {
       Arguments_outFilename(ctx->arguments),
       ctx->codegen->llvmContext);
   ctx->codegen->builder = LLVMCreateBuilderInContext(ctx->codegen->llvmContext);
+  init_target(ctx);
 
   if(Arguments_isDebug(ctx->arguments)) {
     ctx->codegen->debugBuilder = LLVMCreateDIBuilder(ctx->codegen->module);
@@ -133,9 +178,44 @@ void codegen(struct Context* ctx) {
   codegen_main(ctx);
   set_linkage(ctx);
 }
+static void run_passes(struct Context* ctx) {
+  char* passes = Arguments_passes(ctx->arguments);
+  if(!passes) return;
+
+  if(Arguments_timePasses(ctx->arguments)) {
+    // the report is printed to stderr once the pipeline finishes
+    const char* argv[] = {"peblc", "-time-passes"};
+    LLVMParseCommandLineOptions(2, argv, NULL);
+  }
+
+  LLVMPassBuilderOptionsRef options = LLVMCreatePassBuilderOptions();
+  LLVMErrorRef err = LLVMRunPasses(
+      ctx->codegen->module,
+      passes,
+      ctx->codegen->targetMachine,
+      options);
+  LLVMDisposePassBuilderOptions(options);
+  if(err) {
+    // ERROR exits, so copy the message before it is disposed
+    char* llvmErrorMsg = LLVMGetErrorMessage(err);
+    char* errorMsg = bsstrdup(llvmErrorMsg);
+    LLVMDisposeErrorMessage(llvmErrorMsg);
+    ERROR(ctx, "failed to run passes '%s'\n%s\n", passes, errorMsg);
+  }
+}
+
 void cg_emit(struct Context* ctx) {
 
   if(Arguments_isDebug(ctx->arguments)) {
+    // only functions with a body finalize their subprogram, the rest would
+    // keep a temporary node that fails verification
+    LL_FOREACH(ctx->codegen->functions, cg_func) {
+      if(cg_func->di && LLVMCountBasicBlocks(cg_func->function) == 0) {
+        LLVMDIBuilderFinalizeSubprogram(
+            ctx->codegen->debugBuilder,
+            cg_func->di->subprogram);
+      }
+    }
     LLVMDIBuilderFinalize(ctx->codegen->debugBuilder);
   }
   LLVMBool res;
@@ -143,12 +223,42 @@ void cg_emit(struct Context* ctx) {
   res =
       LLVMVerifyModule(ctx->codegen->module, LLVMReturnStatusAction, &errorMsg);
   if(res) {
-    WARNING(ctx, "llvm verifification failed\n%s\n", errorMsg);
+    // invalid IR can still be inspected, but the backend may crash on it
+    if(Arguments_emitKind(ctx->arguments) == ek_LLVM_IR) {
+      WARNING(ctx, "llvm verifification failed\n%s\n", errorMsg);
+    } else {
+      ERROR(ctx, "llvm verifification failed\n%s\n", errorMsg);
+    }
+  } else {
+    // passes may assume valid IR, only optimize what verified
+    run_passes(ctx);
+  }
+  char* outFilename = Arguments_outFilename(ctx->arguments);
+  switch(Arguments_emitKind(ctx->arguments)) {
+    case ek_LLVM_IR:
+      res = LLVMPrintModuleToFile(ctx->codegen->module, outFilename, &errorMsg);
+      break;
+    case ek_BITCODE:
+      res = LLVMWriteBitcodeToFile(ctx->codegen->module, outFilename);
+      errorMsg = "";
+      break;
+    case ek_ASSEMBLY:
+      res = LLVMTargetMachineEmitToFile(
+          ctx->codegen->targetMachine,
+          ctx->codegen->module,
+          outFilename,
+          LLVMAssemblyFile,
+          &errorMsg);
+      break;
+    case ek_OBJECT:
+      res = LLVMTargetMachineEmitToFile(
+          ctx->codegen->targetMachine,
+          ctx->codegen->module,
+          outFilename,
+          LLVMObjectFile,
+          &errorMsg);
+      break;
   }
-  res = LLVMPrintModuleToFile(
-      ctx->codegen->module,
-      Arguments_outFilename(ctx->arguments),
-      &errorMsg);
   if(res) {
     ERROR(
         ctx,
@@ -0,0 +1,80 @@
+#include "common/arena.h"
+
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+  struct ArenaBlock* next;
+  size_t size;
+  size_t used;
+  alignas(max_align_t) unsigned char data[];
+};
+
+// blocks double in size until they hit this, so a large file only costs a
+// handful of mallocs
+#define ARENA_MAX_BLOCK_SIZE ((size_t)16 * 1024 * 1024)
+
+static size_t align_size(size_t size) {
+  size_t align = alignof(max_align_t);
+  return (size + align - 1) & ~(align - 1);
+}
+
+static struct ArenaBlock* ArenaBlock_allocate(size_t size) {
+  struct ArenaBlock* block = malloc(sizeof(*block) + size);
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+  return block;
+}
+
+void Arena_init(struct Arena* arena, size_t initial_size) {
+  arena->blocks = NULL;
+  arena->next_block_size = align_size(initial_size ? initial_size : 1);
+}
+void Arena_deinit(struct Arena* arena) {
+  struct ArenaBlock* block = arena->blocks;
+  while(block) {
+    struct ArenaBlock* next = block->next;
+    free(block);
+    block = next;
+  }
+  arena->blocks = NULL;
+}
+
+void* Arena_allocate(struct Arena* arena, size_t size) {
+  size = align_size(size);
+  struct ArenaBlock* block = arena->blocks;
+  if(!block || block->size - block->used < size) {
+    size_t block_size = arena->next_block_size;
+    while(block_size < size)
+      block_size *= 2;
+    if(arena->next_block_size < ARENA_MAX_BLOCK_SIZE)
+      arena->next_block_size *= 2;
+
+    // the newest block is always at the head
+    block = ArenaBlock_allocate(block_size);
+    block->next = arena->blocks;
+    arena->blocks = block;
+  }
+  void* ptr = block->data + block->used;
+  block->used += size;
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+void Arena_adopt(struct Arena* arena, struct Arena* other) {
+  struct ArenaBlock* blocks = other->blocks;
+  if(!blocks) return;
+  other->blocks = NULL;
+  if(!arena->blocks) {
+    arena->blocks = blocks;
+    return;
+  }
+  // keep the head, it is the block still being allocated from
+  struct ArenaBlock* tail = blocks;
+  while(tail->next)
+    tail = tail->next;
+  tail->next = arena->blocks->next;
+  arena->blocks->next = blocks;
+}
@@ -1,5 +1,6 @@
 #include "common/bsstring.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -43,3 +44,14 @@ long long wcs_to_int(wchar_t* wcs) {
   wchar_t* end;
   return wcstoll(wcs, &end, 10);
 }
+int wcsn_to_int(wchar_t* wcs, int len, long long* value) {
+  const unsigned long long max = LLONG_MAX;
+  unsigned long long res = 0;
+  for(int i = 0; i < len; i++) {
+    unsigned digit = wcs[i] - L'0';
+    if(res > (max - digit) / 10) return 0;
+    res = res * 10 + digit;
+  }
+  *value = (long long)res;
+  return 1;
+}
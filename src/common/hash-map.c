@@ -0,0 +1,123 @@
+#include "common/hash-map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a
+#define HASH_OFFSET_BASIS 0xcbf29ce484222325ull
+#define HASH_PRIME 0x100000001b3ull
+
+uint64_t hash_bytes(const void* data, size_t len) {
+  const unsigned char* bytes = data;
+  uint64_t hash = HASH_OFFSET_BASIS;
+  for(size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= HASH_PRIME;
+  }
+  return hash;
+}
+uint64_t hash_string(const char* s) {
+  uint64_t hash = HASH_OFFSET_BASIS;
+  for(; *s; s++) {
+    hash ^= (unsigned char)*s;
+    hash *= HASH_PRIME;
+  }
+  return hash;
+}
+// pointers are aligned, so mix the low bits that are always 0 away
+static uint64_t hash_pointer(const void* p) {
+  uint64_t x = (uint64_t)(uintptr_t)p;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
+static uint64_t HashMap_hash(struct HashMap* map, const void* key) {
+  return map->string_keys ? hash_string(key) : hash_pointer(key);
+}
+static int HashMap_key_eq(
+    struct HashMap* map,
+    struct HashMapEntry* entry,
+    const void* key,
+    uint64_t hash) {
+  if(map->string_keys)
+    return entry->hash == hash && strcmp(entry->key, key) == 0;
+  return entry->key == key;
+}
+
+static void HashMap_init(struct HashMap* map, int string_keys) {
+  map->entries = NULL;
+  map->capacity = 0;
+  map->size = 0;
+  map->string_keys = string_keys;
+}
+void HashMap_init_strings(struct HashMap* map) { HashMap_init(map, 1); }
+void HashMap_init_pointers(struct HashMap* map) { HashMap_init(map, 0); }
+void HashMap_deinit(struct HashMap* map) {
+  free(map->entries);
+  map->entries = NULL;
+  map->capacity = 0;
+  map->size = 0;
+}
+
+// capacity is always a power of 2, so the probe can mask instead of mod
+static struct HashMapEntry*
+HashMap_find(struct HashMap* map, const void* key, uint64_t hash) {
+  size_t mask = map->capacity - 1;
+  for(size_t i = hash & mask;; i = (i + 1) & mask) {
+    struct HashMapEntry* entry = &map->entries[i];
+    if(entry->key == NULL || HashMap_key_eq(map, entry, key, hash))
+      return entry;
+  }
+}
+
+static void HashMap_grow(struct HashMap* map) {
+  struct HashMapEntry* old = map->entries;
+  size_t old_capacity = map->capacity;
+  map->capacity = old_capacity ? old_capacity * 2 : 16;
+  map->entries = calloc(map->capacity, sizeof(*map->entries));
+  for(size_t i = 0; i < old_capacity; i++) {
+    if(old[i].key) *HashMap_find(map, old[i].key, old[i].hash) = old[i];
+  }
+  free(old);
+}
+
+void* HashMap_get(struct HashMap* map, const void* key) {
+  if(map->size == 0) return NULL;
+  struct HashMapEntry* entry = HashMap_find(map, key, HashMap_hash(map, key));
+  return entry->key ? entry->value : NULL;
+}
+
+// finds the entry for key, adding an empty one if needed
+static struct HashMapEntry*
+HashMap_insert(struct HashMap* map, const void* key, uint64_t hash) {
+  // keep the load factor under 3/4
+  if((map->size + 1) * 4 > map->capacity * 3) HashMap_grow(map);
+  struct HashMapEntry* entry = HashMap_find(map, key, hash);
+  if(!entry->key) {
+    entry->key = key;
+    entry->hash = hash;
+    entry->value = NULL;
+    map->size++;
+  }
+  return entry;
+}
+
+void HashMap_put(struct HashMap* map, const void* key, void* value) {
+  HashMap_insert(map, key, HashMap_hash(map, key))->value = value;
+}
+void* HashMap_put_new(struct HashMap* map, const void* key, void* value) {
+  struct HashMapEntry* entry =
+      HashMap_insert(map, key, HashMap_hash(map, key));
+  if(!entry->value) entry->value = value;
+  return entry->value;
+}
+void HashMap_merge(struct HashMap* map, struct HashMap* other) {
+  for(size_t i = 0; i < other->capacity; i++) {
+    struct HashMapEntry* entry = &other->entries[i];
+    if(!entry->key) continue;
+    struct HashMapEntry* into = HashMap_insert(map, entry->key, entry->hash);
+    if(!into->value) into->value = entry->value;
+  }
+}
@@ -0,0 +1,46 @@
+#include "common/intern.h"
+
+#include "common/arena.h"
+#include "common/hash-map.h"
+
+#include <string.h>
+#include <threads.h>
+
+// the table is split into shards by hash, each with its own lock, so parallel
+// parsing threads rarely wait on each other
+#define INTERN_SHARDS 16
+
+struct InternShard {
+  mtx_t lock;
+  struct HashMap strings;
+  struct Arena storage;
+};
+
+static struct InternShard shards[INTERN_SHARDS];
+static once_flag shards_once = ONCE_FLAG_INIT;
+
+static void init_shards(void) {
+  for(int i = 0; i < INTERN_SHARDS; i++) {
+    mtx_init(&shards[i].lock, mtx_plain);
+    HashMap_init_strings(&shards[i].strings);
+    Arena_init(&shards[i].storage, 16 * 1024);
+  }
+}
+
+char* intern(const char* str) {
+  call_once(&shards_once, init_shards);
+  // use the high bits, the map probes with the low ones
+  struct InternShard* shard =
+      &shards[(hash_string(str) >> 56) % INTERN_SHARDS];
+
+  mtx_lock(&shard->lock);
+  char* interned = HashMap_get(&shard->strings, str);
+  if(!interned) {
+    size_t len = strlen(str) + 1;
+    interned = Arena_allocate(&shard->storage, len);
+    memcpy(interned, str, len);
+    HashMap_put(&shard->strings, interned, interned);
+  }
+  mtx_unlock(&shard->lock);
+  return interned;
+}
@@ -0,0 +1,126 @@
+#include "common/thread-pool.h"
+
+#include <stdlib.h>
+#include <threads.h>
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+struct ThreadPoolTask {
+  ThreadPoolJob job;
+  void* arg;
+  struct ThreadPoolTask* next;
+};
+
+struct ThreadPool {
+  thrd_t* threads;
+  int num_threads;
+
+  mtx_t lock;
+  // signaled when a task is queued or the pool is shutting down
+  cnd_t has_work;
+  // signaled when the last outstanding task finishes
+  cnd_t is_idle;
+
+  struct ThreadPoolTask* head;
+  struct ThreadPoolTask* tail;
+  // queued plus running tasks
+  int outstanding;
+  int shutdown;
+};
+
+static int ThreadPool_worker(void* arg) {
+  struct ThreadPool* pool = arg;
+  mtx_lock(&pool->lock);
+  while(1) {
+    while(!pool->head && !pool->shutdown)
+      cnd_wait(&pool->has_work, &pool->lock);
+    if(!pool->head) break;
+
+    struct ThreadPoolTask* task = pool->head;
+    pool->head = task->next;
+    if(!pool->head) pool->tail = NULL;
+
+    mtx_unlock(&pool->lock);
+    task->job(task->arg);
+    free(task);
+    mtx_lock(&pool->lock);
+
+    pool->outstanding--;
+    if(pool->outstanding == 0) cnd_broadcast(&pool->is_idle);
+  }
+  mtx_unlock(&pool->lock);
+  return 0;
+}
+
+struct ThreadPool* ThreadPool_create(int num_threads) {
+  struct ThreadPool* pool = calloc(1, sizeof(*pool));
+  if(num_threads < 1) num_threads = 1;
+  mtx_init(&pool->lock, mtx_plain);
+  cnd_init(&pool->has_work);
+  cnd_init(&pool->is_idle);
+  pool->threads = malloc(sizeof(*pool->threads) * num_threads);
+  for(int i = 0; i < num_threads; i++) {
+    if(thrd_create(&pool->threads[i], ThreadPool_worker, pool) != thrd_success)
+      break;
+    pool->num_threads++;
+  }
+  return pool;
+}
+
+void ThreadPool_destroy(struct ThreadPool* pool) {
+  ThreadPool_wait(pool);
+  mtx_lock(&pool->lock);
+  pool->shutdown = 1;
+  cnd_broadcast(&pool->has_work);
+  mtx_unlock(&pool->lock);
+  for(int i = 0; i < pool->num_threads; i++) {
+    thrd_join(pool->threads[i], NULL);
+  }
+  cnd_destroy(&pool->is_idle);
+  cnd_destroy(&pool->has_work);
+  mtx_destroy(&pool->lock);
+  free(pool->threads);
+  free(pool);
+}
+
+void ThreadPool_submit(struct ThreadPool* pool, ThreadPoolJob job, void* arg) {
+  // no workers could be started, just run it here
+  if(pool->num_threads == 0) {
+    job(arg);
+    return;
+  }
+  struct ThreadPoolTask* task = malloc(sizeof(*task));
+  task->job = job;
+  task->arg = arg;
+  task->next = NULL;
+
+  mtx_lock(&pool->lock);
+  if(pool->tail) pool->tail->next = task;
+  else pool->head = task;
+  pool->tail = task;
+  pool->outstanding++;
+  cnd_signal(&pool->has_work);
+  mtx_unlock(&pool->lock);
+}
+
+void ThreadPool_wait(struct ThreadPool* pool) {
+  mtx_lock(&pool->lock);
+  while(pool->outstanding > 0)
+    cnd_wait(&pool->is_idle, &pool->lock);
+  mtx_unlock(&pool->lock);
+}
+
+int ThreadPool_hardware_threads(void) {
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+#else
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+#endif
+}
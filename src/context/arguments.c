@@ -2,6 +2,7 @@
 #include "context/arguments.h"
 
 #include "common/bsstring.h"
+#include "common/thread-pool.h"
 #include "context/context.h"
 
 #include <stdlib.h>
@@ -13,9 +14,20 @@ create_Arguments(char* inFilename, char* outFilename, int isDebug) {
   args->inFilename = inFilename ? bsstrdup(inFilename) : NULL;
   args->outFilename = outFilename ? bsstrdup(outFilename) : NULL;
   args->isDebug = isDebug;
+  args->numThreads = 1;
+  args->lazyBodies = 0;
+  args->emitKind = ek_LLVM_IR;
+  args->passes = NULL;
+  args->timePasses = 0;
 
   return args;
 }
+void destroy_Arguments(struct Arguments* args) {
+  free(args->inFilename);
+  free(args->outFilename);
+  free(args->passes);
+  free(args);
+}
 
 char* Arguments_inFilename(struct Arguments* args) {
   ASSERT(args && args->inFilename);
@@ -29,3 +41,45 @@ int Arguments_isDebug(struct Arguments* args) {
   ASSERT(args);
   return args->isDebug;
 }
+int Arguments_numThreads(struct Arguments* args) {
+  ASSERT(args);
+  return args->numThreads;
+}
+void Arguments_setNumThreads(struct Arguments* args, int numThreads) {
+  ASSERT(args && numThreads >= 0);
+  args->numThreads =
+      numThreads == 0 ? ThreadPool_hardware_threads() : numThreads;
+}
+int Arguments_lazyBodies(struct Arguments* args) {
+  ASSERT(args);
+  return args->lazyBodies;
+}
+void Arguments_setLazyBodies(struct Arguments* args, int lazyBodies) {
+  ASSERT(args);
+  args->lazyBodies = lazyBodies;
+}
+enum EmitKind Arguments_emitKind(struct Arguments* args) {
+  ASSERT(args);
+  return args->emitKind;
+}
+void Arguments_setEmitKind(struct Arguments* args, enum EmitKind emitKind) {
+  ASSERT(args);
+  args->emitKind = emitKind;
+}
+char* Arguments_passes(struct Arguments* args) {
+  ASSERT(args);
+  return args->passes;
+}
+void Arguments_setPasses(struct Arguments* args, char* passes) {
+  ASSERT(args);
+  free(args->passes);
+  args->passes = passes ? bsstrdup(passes) : NULL;
+}
+int Arguments_timePasses(struct Arguments* args) {
+  ASSERT(args);
+  return args->timePasses;
+}
+void Arguments_setTimePasses(struct Arguments* args, int timePasses) {
+  ASSERT(args);
+  args->timePasses = timePasses;
+}
@@ -17,7 +17,19 @@ struct Context* Context_allocate() {
 void Context_init(struct Context* context, struct Arguments* args) {
   memset(context, 0, sizeof(*context));
   context->arguments = args;
+  Arena_init(&context->ast_arena, 64 * 1024);
+  HashMap_init_pointers(&context->locations);
   setlocale(LC_CTYPE, "");
 }
+void Context_deinit(struct Context* context) {
+  scope_deinit(context);
+  HashMap_deinit(&context->locations);
+  Arena_deinit(&context->ast_arena);
+  context->ast = NULL;
+}
 
 void BREAKPOINT() {}
+
+void Context_begin_diagnostic(struct Context* context) {
+  if(context && context->diagnostic_gate) context->diagnostic_gate(context);
+}
@@ -0,0 +1,137 @@
+#include "lexer-scan.h"
+
+#include <stdint.h>
+
+// the vector paths assume 32-bit wchar_t, otherwise only the scalar one is used
+#if WCHAR_MAX > 0xFFFF && defined(__AVX2__)
+  #include <immintrin.h>
+  #define SCAN_AVX2
+#elif WCHAR_MAX > 0xFFFF && defined(__SSE2__)
+  #include <emmintrin.h>
+  #define SCAN_SSE2
+#endif
+
+static int is_ascii_space(wchar_t c) {
+  return c == L' ' || (c >= L'\t' && c <= L'\r');
+}
+static int is_ascii_ident(wchar_t c) {
+  return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') ||
+         (c >= L'0' && c <= L'9') || c == L'_';
+}
+static int is_ascii_digit(wchar_t c) { return c >= L'0' && c <= L'9'; }
+
+#if defined(SCAN_AVX2)
+
+// 8 chars at a time, masks have one bit per char
+  #define LANES 8
+typedef __m256i vec;
+static vec vload(wchar_t* p) { return _mm256_loadu_si256((__m256i*)p); }
+static vec vsplat(int x) { return _mm256_set1_epi32(x); }
+static vec veq(vec a, vec b) { return _mm256_cmpeq_epi32(a, b); }
+static vec vgt(vec a, vec b) { return _mm256_cmpgt_epi32(a, b); }
+static vec vor(vec a, vec b) { return _mm256_or_si256(a, b); }
+static vec vand(vec a, vec b) { return _mm256_and_si256(a, b); }
+static unsigned vmask(vec a) {
+  return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a));
+}
+
+#elif defined(SCAN_SSE2)
+
+// 4 chars at a time, masks have one bit per char
+  #define LANES 4
+typedef __m128i vec;
+static vec vload(wchar_t* p) { return _mm_loadu_si128((__m128i*)p); }
+static vec vsplat(int x) { return _mm_set1_epi32(x); }
+static vec veq(vec a, vec b) { return _mm_cmpeq_epi32(a, b); }
+static vec vgt(vec a, vec b) { return _mm_cmpgt_epi32(a, b); }
+static vec vor(vec a, vec b) { return _mm_or_si128(a, b); }
+static vec vand(vec a, vec b) { return _mm_and_si128(a, b); }
+static unsigned vmask(vec a) {
+  return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(a));
+}
+
+#endif
+
+#if defined(LANES)
+
+  #define ALL_LANES ((1u << LANES) - 1)
+
+// lo <= c <= hi, wchar_t is signed so the compares are as well
+static vec vrange(vec c, int lo, int hi) {
+  return vand(vgt(c, vsplat(lo - 1)), vgt(vsplat(hi + 1), c));
+}
+
+int scan_whitespace(wchar_t* buf, int pos, int len, int* lines) {
+  for(; pos + LANES <= len; pos += LANES) {
+    vec c = vload(buf + pos);
+    unsigned space = vmask(vor(veq(c, vsplat(L' ')), vrange(c, L'\t', L'\r')));
+    unsigned newline = vmask(veq(c, vsplat(L'\n')));
+    if(space != ALL_LANES) {
+      int stop = __builtin_ctz(~space);
+      *lines += __builtin_popcount(newline & ((1u << stop) - 1));
+      return pos + stop;
+    }
+    *lines += __builtin_popcount(newline);
+  }
+  for(; pos < len && is_ascii_space(buf[pos]); pos++) {
+    if(buf[pos] == L'\n') (*lines)++;
+  }
+  return pos;
+}
+
+int scan_to_eol(wchar_t* buf, int pos, int len) {
+  for(; pos + LANES <= len; pos += LANES) {
+    vec c = vload(buf + pos);
+    unsigned eol = vmask(vor(veq(c, vsplat(L'\n')), veq(c, vsplat(L'\r'))));
+    if(eol) return pos + __builtin_ctz(eol);
+  }
+  for(; pos < len && buf[pos] != L'\n' && buf[pos] != L'\r'; pos++)
+    ;
+  return pos;
+}
+
+int scan_identifier(wchar_t* buf, int pos, int len, int* all_digits) {
+  for(; pos + LANES <= len; pos += LANES) {
+    vec c = vload(buf + pos);
+    // setting 0x20 folds upper case onto lower case
+    vec lower = vor(c, vsplat(0x20));
+    unsigned digit = vmask(vrange(c, L'0', L'9'));
+    unsigned ident = digit | vmask(vor(
+                                 vrange(lower, L'a', L'z'),
+                                 veq(c, vsplat(L'_'))));
+    if(ident != ALL_LANES) {
+      int stop = __builtin_ctz(~ident);
+      if((digit & ((1u << stop) - 1)) != ((1u << stop) - 1)) *all_digits = 0;
+      return pos + stop;
+    }
+    if(digit != ALL_LANES) *all_digits = 0;
+  }
+  for(; pos < len && is_ascii_ident(buf[pos]); pos++) {
+    if(!is_ascii_digit(buf[pos])) *all_digits = 0;
+  }
+  return pos;
+}
+
+#else
+
+int scan_whitespace(wchar_t* buf, int pos, int len, int* lines) {
+  for(; pos < len && is_ascii_space(buf[pos]); pos++) {
+    if(buf[pos] == L'\n') (*lines)++;
+  }
+  return pos;
+}
+
+int scan_to_eol(wchar_t* buf, int pos, int len) {
+  for(; pos < len && buf[pos] != L'\n' && buf[pos] != L'\r'; pos++)
+    ;
+  return pos;
+}
+
+int scan_identifier(wchar_t* buf, int pos, int len, int* all_digits) {
+  for(; pos < len && is_ascii_ident(buf[pos]); pos++) {
+    if(!is_ascii_digit(buf[pos])) *all_digits = 0;
+  }
+  return pos;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef LEXER_SCAN_H_
+#define LEXER_SCAN_H_
+
+#include <wchar.h>
+
+// ASCII fast paths for the lexer. each scan starts at `pos` and returns the
+// position of the first char it does not accept (or `len`), never looking past
+// `len`. non-ASCII chars are never accepted, the caller must handle them
+
+// skips ' ', '\t', '\n', '\v', '\f' and '\r', adding the newlines to `lines`
+int scan_whitespace(wchar_t* buf, int pos, int len, int* lines);
+// finds the next '\n' or '\r', skipping anything else (even non-ASCII)
+int scan_to_eol(wchar_t* buf, int pos, int len);
+// skips [A-Za-z0-9_], clearing `all_digits` if anything but [0-9] is seen
+int scan_identifier(wchar_t* buf, int pos, int len, int* all_digits);
+
+#endif
@@ -9,27 +9,91 @@
 #include <string.h>
 #include <wctype.h>
 
-#define MIN_LEXEME_SIZE 8
+#include "lexer-scan.h"
+
+// tokens are small, so start the arena with room for a good number of them
+#define TOKEN_ARENA_SIZE (sizeof(struct lexer_token) * 1024)
 
 enum lexer_tokentype LT_type(struct lexer_token* t) { return t->tt; }
 wchar_t* LT_lexeme(struct lexer_token* t) { return t->lexeme; }
+int LT_lexeme_len(struct lexer_token* t) { return t->lexeme_len; }
 int LT_lineno(struct lexer_token* t) { return t->lineno; }
 
+// read the whole file and decode it to wide chars in one go, so the lexer can
+// move around the source by just moving an index
+static void read_source_file(struct Context* context, FILE* fp) {
+  int res = fseek(fp, 0, SEEK_END);
+  ASSERT_MSG(!res, "fseek() failed - %s\n", strerror(errno));
+  long n_bytes = ftell(fp);
+  ASSERT_MSG(n_bytes != -1, "ftell() failed - %s\n", strerror(errno));
+  rewind(fp);
+
+  char* bytes = malloc(sizeof(*bytes) * (n_bytes + 1));
+  size_t n_read = fread(bytes, sizeof(*bytes), n_bytes, fp);
+  ASSERT_MSG(
+      n_read == (size_t)n_bytes,
+      "fread() failed - %s\n",
+      strerror(errno));
+
+  // there can never be more wide chars than bytes
+  wchar_t* buffer = malloc(sizeof(*buffer) * (n_bytes + 1));
+  int len = 0;
+  mbstate_t state;
+  memset(&state, 0, sizeof(state));
+  size_t idx = 0;
+  while(idx < n_read) {
+    wchar_t c;
+    size_t n = mbrtowc(&c, bytes + idx, n_read - idx, &state);
+    // an invalid or truncated sequence ends the input, same as fgetwc
+    if(n == (size_t)-1 || n == (size_t)-2) break;
+    // embedded NUL
+    if(n == 0) n = 1;
+    buffer[len++] = c;
+    idx += n;
+  }
+  buffer[len] = L'\0';
+  free(bytes);
+
+  context->lexer->buffer = buffer;
+  context->lexer->buffer_len = len;
+  context->lexer->position = 0;
+}
+
 void lexer_init(struct Context* context) {
   context->lexer = malloc(sizeof(*context->lexer));
   memset(context->lexer, 0, sizeof(*context->lexer));
 
-  context->lexer->fp = fopen(Arguments_inFilename(context->arguments), "rb");
-  if(context->lexer->fp == NULL) {
+  FILE* fp = fopen(Arguments_inFilename(context->arguments), "rb");
+  if(fp == NULL) {
     ERROR(
         context,
         "could not open file named '%s'\n",
         Arguments_inFilename(context->arguments));
   }
+  read_source_file(context, fp);
+  fclose(fp);
   context->lexer->current_line = 1;
+  Arena_init(&context->lexer->token_arena, TOKEN_ARENA_SIZE);
+}
+void lexer_init_view(
+    struct Context* context,
+    struct lexer_state* source,
+    int start,
+    int end,
+    int line) {
+  ASSERT(0 <= start && start <= end && end <= source->buffer_len);
+  context->lexer = malloc(sizeof(*context->lexer));
+  memset(context->lexer, 0, sizeof(*context->lexer));
+  context->lexer->buffer = source->buffer;
+  context->lexer->buffer_len = end;
+  context->lexer->is_view = 1;
+  context->lexer->position = start;
+  context->lexer->current_line = line;
+  Arena_init(&context->lexer->token_arena, TOKEN_ARENA_SIZE);
 }
 void lexer_deinit(struct Context* context) {
-  fclose(context->lexer->fp);
+  Arena_deinit(&context->lexer->token_arena);
+  if(!context->lexer->is_view) free(context->lexer->buffer);
   free(context->lexer);
 }
 static struct lexer_token* lexer_gettoken_internal(struct Context* context);
@@ -49,10 +113,13 @@ struct lexer_token* lexer_peek(struct Context* context, int lookahead) {
   }
 }
 
+// an empty view at the current position
 static struct lexer_token* empty_token(struct Context* context) {
-  struct lexer_token* t = malloc(sizeof(*t));
+  struct lexer_token* t =
+      Arena_allocate(&context->lexer->token_arena, sizeof(*t));
   t->tt = tt_ERROR;
-  t->lexeme = calloc(MIN_LEXEME_SIZE, sizeof(*t->lexeme));
+  t->lexeme = context->lexer->buffer + context->lexer->position;
+  t->lexeme_len = 0;
   t->lineno = context->lexer->current_line;
   return t;
 }
@@ -62,39 +129,32 @@ static struct lexer_token* eof_token(struct Context* context) {
   return t;
 }
 
+// builds a token whose lexeme is the `len` chars that were just consumed
 static struct lexer_token* build_simple_token(
     struct Context* context,
     enum lexer_tokentype tt,
-    wchar_t c) {
-  struct lexer_token* t = empty_token(context);
-  t->tt = tt;
-  t->lexeme[0] = c;
-  return t;
-}
-static struct lexer_token* build_simple_token2(
-    struct Context* context,
-    enum lexer_tokentype tt,
-    wchar_t c1,
-    wchar_t c2) {
+    int len) {
   struct lexer_token* t = empty_token(context);
   t->tt = tt;
-  t->lexeme[0] = c1;
-  t->lexeme[1] = c2;
+  t->lexeme -= len;
+  t->lexeme_len = len;
   return t;
 }
 static void seek_pos(struct Context* context, int pos) {
-  // we have to use the tell pos and not just go -1 on SEEK_CUR due to stupid
-  // windows
-  int res = fseek(context->lexer->fp, pos, SEEK_SET);
-  ASSERT_MSG(!res, "fseek() failed - %s\n", strerror(errno));
+  ASSERT_MSG(
+      pos >= 0 && pos <= context->lexer->buffer_len,
+      "invalid source position %d\n",
+      pos);
+  context->lexer->position = pos;
 }
 
 static wchar_t get_char(struct Context* context) {
-  return fgetwc(context->lexer->fp);
+  // reading at the end does not move the position, same as fgetwc
+  if(context->lexer->position >= context->lexer->buffer_len) return WEOF;
+  return context->lexer->buffer[context->lexer->position++];
 }
 static int get_char_pos(struct Context* context, wchar_t* c) {
-  int pos = ftell(context->lexer->fp);
-  ASSERT_MSG(pos != -1, "ftell() failed - %s\n", strerror(errno));
+  int pos = context->lexer->position;
   *c = get_char(context);
   return pos;
 }
@@ -105,41 +165,79 @@ __attribute__((unused)) static wchar_t peek_char(struct Context* context) {
   return c;
 }
 
+// skips a string or char literal body the same way the lexer would, assumes
+// the opening quote was already eaten
+static int skip_literal(wchar_t* buf, int pos, int len, wchar_t quote) {
+  while(pos < len && buf[pos] != quote) {
+    // an escape always consumes the char after it
+    pos += buf[pos] == L'\\' ? 2 : 1;
+  }
+  return pos + 1;
+}
+
+int lexer_skip_block(struct Context* context, int* start, int* start_line) {
+  struct lexer_state* lexer = context->lexer;
+  struct lexer_token* t = lexer_peek(context, 1);
+  if(LT_type(t) != tt_LCURLY || lexer->peeked[1] != NULL) return 0;
+
+  wchar_t* buf = lexer->buffer;
+  int len = lexer->buffer_len;
+  // peeking the '{' left the position just past it
+  int pos = lexer->position;
+  int line = LT_lineno(t);
+  int depth = 1;
+  while(pos < len && depth > 0) {
+    wchar_t c = buf[pos++];
+    if(c == L'{') depth++;
+    else if(c == L'}') depth--;
+    else if(c == L'\n') line++;
+    else if(c == L'#') pos = scan_to_eol(buf, pos, len);
+    else if(c == L'"' || c == L'\'') pos = skip_literal(buf, pos, len, c);
+  }
+  if(depth > 0) return 0;
+
+  *start = t->lexeme - buf;
+  *start_line = LT_lineno(t);
+  lexer->peeked[0] = NULL;
+  lexer->position = pos;
+  lexer->current_line = line;
+  return 1;
+}
+
 static void skip_whitespace_comments(struct Context* context) {
+  struct lexer_state* lexer = context->lexer;
   while(1) {
+    lexer->position = scan_whitespace(
+        lexer->buffer,
+        lexer->position,
+        lexer->buffer_len,
+        &lexer->current_line);
     wchar_t c;
     int pos = get_char_pos(context, &c);
-    if(c == L'\n') {
-      context->lexer->current_line++;
-    } else if(iswspace(c)) {
-      // continue
-    } else if(c == L'#') {
-      while(1) {
-        c = get_char(context);
-        if(c == L'\n' || c == L'\r' || c == EOF) {
-          if(c == L'\n') {
-            context->lexer->current_line++;
-          }
-          break;
-        }
-      }
+    if(c == L'#') {
+      // the newline is left for scan_whitespace to count
+      lexer->position =
+          scan_to_eol(lexer->buffer, lexer->position, lexer->buffer_len);
+    } else if(c != EOF && c > 0x7f && iswspace(c)) {
+      // slow path for unicode whitespace
     } else {
       seek_pos(context, pos);
       break;
     }
   }
 }
-
 // assumes we have already eaten the ', just reads until the next '
 static struct lexer_token* handle_char_literal(struct Context* context) {
   struct lexer_token* t = empty_token(context);
   wchar_t literal;
   int pos = get_char_pos(context, &literal);
+  int is_escaped = 0;
   if(literal == EOF) {
     // put the eof back and return error
     seek_pos(context, pos);
     return t;
   } else if(literal == L'\\') {
+    is_escaped = 1;
     // consume the '\'
     literal = get_char(context);
     // if the escape is a valid escape, keep it
@@ -162,7 +260,16 @@ static struct lexer_token* handle_char_literal(struct Context* context) {
   if(next != L'\'') {
     return t;
   }
-  t->lexeme[0] = literal;
+  if(is_escaped) {
+    // the source doesn't contain the decoded char, so store it
+    wchar_t* decoded =
+        Arena_allocate(&context->lexer->token_arena, sizeof(*decoded));
+    *decoded = literal;
+    t->lexeme = decoded;
+  } else {
+    t->lexeme = context->lexer->buffer + pos;
+  }
+  t->lexeme_len = 1;
   t->tt = tt_CHAR_LITERAL;
   return t;
 }
@@ -205,59 +312,87 @@ static int handle_strings_get_char(struct Context* context, wchar_t* next) {
 static struct lexer_token* handle_strings(struct Context* context) {
   struct lexer_token* t = empty_token(context);
 
-  int lexemeSize = MIN_LEXEME_SIZE;
+  int start = context->lexer->position;
   int nChars = 0;
+  int has_escapes = 0;
   // read until we run out of chars or a space is encountered
   while(1) {
+    int pos = context->lexer->position;
     wchar_t next;
     int res = handle_strings_get_char(context, &next);
     if(res == 1) break;
-    else if(res == -1) return t; // ERROR
-
-    if(nChars >= lexemeSize) {
-      lexemeSize *= 2;
-      t->lexeme = realloc(t->lexeme, sizeof(*t->lexeme) * lexemeSize);
+    else if(res == -1) {
+      // ERROR, report what was read so far
+      t->lexeme = context->lexer->buffer + start;
+      t->lexeme_len = nChars;
+      return t;
     }
-    t->lexeme[nChars] = next;
+
+    if(context->lexer->buffer[pos] == L'\\') has_escapes = 1;
     nChars++;
   }
-  // allocate just a bit more if needed for NUL
-  if(nChars >= lexemeSize) {
-    lexemeSize += 1;
-    t->lexeme = realloc(t->lexeme, sizeof(*t->lexeme) * lexemeSize);
+
+  if(has_escapes) {
+    // only strings with escapes need a copy, decode them again into it
+    int end = context->lexer->position;
+    wchar_t* decoded = Arena_allocate(
+        &context->lexer->token_arena,
+        sizeof(*decoded) * nChars);
+    seek_pos(context, start);
+    for(int i = 0; i < nChars; i++) {
+      handle_strings_get_char(context, &decoded[i]);
+    }
+    seek_pos(context, end);
+    t->lexeme = decoded;
+  } else {
+    t->lexeme = context->lexer->buffer + start;
   }
-  t->lexeme[nChars] = L'\0';
+  t->lexeme_len = nChars;
 
   // its a valid string literal
   t->tt = tt_STRING_LITERAL;
   return t;
 }
 
-static int is_valid_id(wchar_t* s) {
-  // first char must be alnum or _
-  if(!iswalpha(s[0]) && s[0] != L'_') return 0;
-
-  int i = 1;
-  while(s[i] != 0) {
-    if(!iswalnum(s[i]) && s[i] != L'_') return 0;
-    i++;
-  }
-  return i > 0;
-}
-static int is_valid_num(wchar_t* s) {
-  int i = 0;
-  while(s[i] != 0) {
-    if(!iswdigit(s[i])) return 0;
-    i++;
-  }
-  return i > 0;
+// as large as the longest keyword spelling
+union keyword_spellings {
+#define KEYWORD(name, spelling) char kw_##name[sizeof(#spelling)];
+#include "definitions/tokens.def"
+};
+#define MAX_KEYWORD_LEN ((int)sizeof(union keyword_spellings) - 1)
+
+// compares against every keyword, but inlined with a constant `len` only the
+// keywords of that length are left. within a length the first char rules out
+// nearly all of them
+__attribute__((always_inline)) static inline enum lexer_tokentype
+keyword_of_len(wchar_t* s, int len) {
+#define KEYWORD(name, spelling)                                                \
+  if((int)sizeof(#spelling) - 1 == len && s[0] == (wchar_t) #spelling[0] &&    \
+     wmemcmp(s, L"" #spelling, len) == 0)                                      \
+    return tt_##name;
+#include "definitions/tokens.def"
+  return tt_ID;
 }
 
-static int is_keyword(wchar_t* s, wchar_t* keyword) {
-  if(wcslen(s) != wcslen(keyword)) return 0;
-  if(wcscmp(s, keyword) != 0) return 0;
-  return 1;
+#define KEYWORD_LEN_CASE(n)                                                    \
+  case n: return keyword_of_len(s, n);
+_Static_assert(
+    MAX_KEYWORD_LEN <= 8,
+    "keyword_lookup needs a case for the longest keyword");
+static enum lexer_tokentype keyword_lookup(wchar_t* s, int len) {
+  switch(len) {
+    KEYWORD_LEN_CASE(1)
+    KEYWORD_LEN_CASE(2)
+    KEYWORD_LEN_CASE(3)
+    KEYWORD_LEN_CASE(4)
+    KEYWORD_LEN_CASE(5)
+    KEYWORD_LEN_CASE(6)
+    KEYWORD_LEN_CASE(7)
+    KEYWORD_LEN_CASE(8)
+    default: return tt_ID;
+  }
 }
+#undef KEYWORD_LEN_CASE
 
 struct lexer_token* lexer_gettoken(struct Context* context) {
 
@@ -281,17 +416,17 @@ static struct lexer_token* lexer_gettoken_internal(struct Context* context) {
   }
 
   switch(c1) {
-    case L'(': return build_simple_token(context, tt_LPAREN, c1);
-    case L')': return build_simple_token(context, tt_RPAREN, c1);
-    case L'{': return build_simple_token(context, tt_LCURLY, c1);
-    case L'}': return build_simple_token(context, tt_RCURLY, c1);
-    case L',': return build_simple_token(context, tt_COMMA, c1);
-    case L':': return build_simple_token(context, tt_COLON, c1);
-    case L';': return build_simple_token(context, tt_SEMICOLON, c1);
-    case L'+': return build_simple_token(context, tt_PLUS, c1);
-    case L'*': return build_simple_token(context, tt_STAR, c1);
-    case L'/': return build_simple_token(context, tt_DIVIDE, c1);
-    case L'.': return build_simple_token(context, tt_DOT, c1);
+    case L'(': return build_simple_token(context, tt_LPAREN, 1);
+    case L')': return build_simple_token(context, tt_RPAREN, 1);
+    case L'{': return build_simple_token(context, tt_LCURLY, 1);
+    case L'}': return build_simple_token(context, tt_RCURLY, 1);
+    case L',': return build_simple_token(context, tt_COMMA, 1);
+    case L':': return build_simple_token(context, tt_COLON, 1);
+    case L';': return build_simple_token(context, tt_SEMICOLON, 1);
+    case L'+': return build_simple_token(context, tt_PLUS, 1);
+    case L'*': return build_simple_token(context, tt_STAR, 1);
+    case L'/': return build_simple_token(context, tt_DIVIDE, 1);
+    case L'.': return build_simple_token(context, tt_DOT, 1);
   }
 
   // handle strings
@@ -308,46 +443,46 @@ static struct lexer_token* lexer_gettoken_internal(struct Context* context) {
   int pos2 = get_char_pos(context, &c2);
 
   if(c1 == L'-') {
-    if(c2 == L'>') return build_simple_token2(context, tt_ARROW, c1, c2);
+    if(c2 == L'>') return build_simple_token(context, tt_ARROW, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_MINUS, c1);
+      return build_simple_token(context, tt_MINUS, 1);
     }
   } else if(c1 == L'&') {
-    if(c2 == L'&') return build_simple_token2(context, tt_AND, c1, c2);
+    if(c2 == L'&') return build_simple_token(context, tt_AND, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_AMPERSAND, c1);
+      return build_simple_token(context, tt_AMPERSAND, 1);
     }
   } else if(c1 == L'|') {
-    if(c2 == L'|') return build_simple_token2(context, tt_OR, c1, c2);
+    if(c2 == L'|') return build_simple_token(context, tt_OR, 2);
     else {
       seek_pos(context, pos2);
       return build_simple_token(context, tt_ERROR, 0);
     }
   } else if(c1 == L'=') {
-    if(c2 == L'=') return build_simple_token2(context, tt_EQ, c1, c2);
+    if(c2 == L'=') return build_simple_token(context, tt_EQ, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_EQUALS, c1);
+      return build_simple_token(context, tt_EQUALS, 1);
     }
   } else if(c1 == L'!') {
-    if(c2 == L'=') return build_simple_token2(context, tt_NEQ, c1, c2);
+    if(c2 == L'=') return build_simple_token(context, tt_NEQ, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_NOT, c1);
+      return build_simple_token(context, tt_NOT, 1);
     }
   } else if(c1 == L'<') {
-    if(c2 == L'=') return build_simple_token2(context, tt_LTEQ, c1, c2);
+    if(c2 == L'=') return build_simple_token(context, tt_LTEQ, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_LT, c1);
+      return build_simple_token(context, tt_LT, 1);
     }
   } else if(c1 == L'>') {
-    if(c2 == L'=') return build_simple_token2(context, tt_GTEQ, c1, c2);
+    if(c2 == L'=') return build_simple_token(context, tt_GTEQ, 2);
     else {
       seek_pos(context, pos2);
-      return build_simple_token(context, tt_GT, c1);
+      return build_simple_token(context, tt_GT, 1);
     }
   }
 
@@ -356,102 +491,46 @@ static struct lexer_token* lexer_gettoken_internal(struct Context* context) {
   seek_pos(context, pos1);
 
   struct lexer_token* t = empty_token(context);
-  int lexemeSize = MIN_LEXEME_SIZE;
-  int nChars = 0;
+  int all_digits = 1;
+  context->lexer->position = scan_identifier(
+      context->lexer->buffer,
+      context->lexer->position,
+      context->lexer->buffer_len,
+      &all_digits);
+  // slow path, only hit once a non-ASCII char is found
   wchar_t next;
-  // read until we run out of chars or a non alphanumeric/underscore is found
   while(1) {
     int pos = get_char_pos(context, &next);
-    if(!iswalnum(next) && next != L'_') {
-      seek_pos(context, pos);
-      break;
-    }
-    if(next == EOF) {
-      // put the EOF back
+    if(next == EOF || (!iswalnum(next) && next != L'_')) {
+      // put the char back
       seek_pos(context, pos);
       break;
     }
-
-    if(nChars >= lexemeSize) {
-      lexemeSize *= 2;
-      t->lexeme = realloc(t->lexeme, sizeof(*t->lexeme) * lexemeSize);
-    }
-    t->lexeme[nChars] = next;
-    nChars++;
-  }
-  // allocate just a bit more if needed for NUL
-  if(nChars >= lexemeSize) {
-    lexemeSize += 1;
-    t->lexeme = realloc(t->lexeme, sizeof(*t->lexeme) * lexemeSize);
+    if(!iswdigit(next)) all_digits = 0;
   }
-  t->lexeme[nChars] = L'\0';
-
-  wchar_t* tokenLexeme = LT_lexeme(t);
-  if(is_keyword(tokenLexeme, L"if")) t->tt = tt_IF;
-  else if(is_keyword(tokenLexeme, L"else")) t->tt = tt_ELSE;
-  else if(is_keyword(tokenLexeme, L"while")) t->tt = tt_WHILE;
-  else if(is_keyword(tokenLexeme, L"return")) t->tt = tt_RETURN;
-  else if(is_keyword(tokenLexeme, L"break")) t->tt = tt_BREAK;
-  else if(is_keyword(tokenLexeme, L"func")) t->tt = tt_FUNC;
-  else if(is_keyword(tokenLexeme, L"extern")) t->tt = tt_EXTERN;
-  else if(is_keyword(tokenLexeme, L"export")) t->tt = tt_EXPORT;
-  else if(is_keyword(tokenLexeme, L"type")) t->tt = tt_TYPE;
-  else if(is_keyword(tokenLexeme, L"let")) t->tt = tt_LET;
-  else if(is_keyword(tokenLexeme, L"true")) t->tt = tt_TRUE;
-  else if(is_keyword(tokenLexeme, L"false")) t->tt = tt_FALSE;
-  else if(is_keyword(tokenLexeme, L"null")) t->tt = tt_NULL;
-  // THESE MUST GO LAST
-  else if(is_valid_id(tokenLexeme)) t->tt = tt_ID;
-  else if(is_valid_num(tokenLexeme)) t->tt = tt_NUMBER;
-  else {
-    if(wcslen(tokenLexeme) == 0 && peek_char(context) == EOF) t->tt = tt_EOF;
+  int len = context->lexer->position - pos1;
+  t->lexeme_len = len;
+
+  // every char is alnum or '_', so only the first char needs checking for IDs
+  if(len == 0) {
+    if(peek_char(context) == EOF) t->tt = tt_EOF;
+  } else if(all_digits) {
+    t->tt = tt_NUMBER;
+  } else if(iswalpha(t->lexeme[0]) || t->lexeme[0] == L'_') {
+    t->tt = keyword_lookup(t->lexeme, len);
   }
 
   return t;
 }
 
+static wchar_t* tokentype_names[] = {
+#define TOKEN(name) L"" #name,
+#define KEYWORD(name, spelling) L"" #name,
+#include "definitions/tokens.def"
+};
 wchar_t* tokentype_to_string(enum lexer_tokentype tt) {
-  if(tt == tt_EOF) return L"EOF";
-  else if(tt == tt_ERROR) return L"ERROR";
-  else if(tt == tt_ID) return L"ID";
-  else if(tt == tt_NUMBER) return L"NUMBER";
-  else if(tt == tt_TRUE) return L"TRUE";
-  else if(tt == tt_FALSE) return L"FALSE";
-  else if(tt == tt_NULL) return L"NULL";
-  else if(tt == tt_STRING_LITERAL) return L"STRING_LITERAL";
-  else if(tt == tt_CHAR_LITERAL) return L"CHAR_LITERAL";
-  else if(tt == tt_LPAREN) return L"LPAREN";
-  else if(tt == tt_RPAREN) return L"RPAREN";
-  else if(tt == tt_LCURLY) return L"LCURLY";
-  else if(tt == tt_RCURLY) return L"RCURLY";
-  else if(tt == tt_COMMA) return L"COMMA";
-  else if(tt == tt_COLON) return L"COLON";
-  else if(tt == tt_DOT) return L"DOT";
-  else if(tt == tt_ARROW) return L"ARROW";
-  else if(tt == tt_SEMICOLON) return L"SEMICOLON";
-  else if(tt == tt_FUNC) return L"FUNC";
-  else if(tt == tt_EXTERN) return L"EXTERN";
-  else if(tt == tt_TYPE) return L"TYPE";
-  else if(tt == tt_LET) return L"LET";
-  else if(tt == tt_PLUS) return L"PLUS";
-  else if(tt == tt_MINUS) return L"MINUS";
-  else if(tt == tt_STAR) return L"STAR";
-  else if(tt == tt_DIVIDE) return L"DIVIDE";
-  else if(tt == tt_AND) return L"AND";
-  else if(tt == tt_OR) return L"OR";
-  else if(tt == tt_LT) return L"LT";
-  else if(tt == tt_GT) return L"GT";
-  else if(tt == tt_LTEQ) return L"LTEQ";
-  else if(tt == tt_GTEQ) return L"GTEQ";
-  else if(tt == tt_EQ) return L"EQ";
-  else if(tt == tt_NEQ) return L"NEQ";
-  else if(tt == tt_EQUALS) return L"EQUALS";
-  else if(tt == tt_AMPERSAND) return L"AMPERSAND";
-  else if(tt == tt_NOT) return L"NOT";
-  else if(tt == tt_IF) return L"IF";
-  else if(tt == tt_ELSE) return L"ELSE";
-  else if(tt == tt_WHILE) return L"WHILE";
-  else if(tt == tt_RETURN) return L"RETURN";
-  else if(tt == tt_BREAK) return L"BREAK";
-  UNIMPLEMENTED("unknown token type %d\n", tt);
+  if(tt < 0 ||
+     (size_t)tt >= sizeof(tokentype_names) / sizeof(tokentype_names[0]))
+    UNIMPLEMENTED("unknown token type %d\n", tt);
+  return tokentype_names[tt];
 }
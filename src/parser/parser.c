@@ -2,15 +2,29 @@
 
 #include "ast/location.h"
 #include "common/bsstring.h"
+#include "common/hash-map.h"
+#include "common/intern.h"
+#include "common/ll-common.h"
+#include "common/thread-pool.h"
+#include "context/arguments.h"
 #include "context/context.h"
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <threads.h>
 
-static struct AstNode* parse_statement_list(struct Context* context);
-static struct AstNode* parse_statement(struct Context* context);
+struct ParseJobs;
+
+static struct AstNode*
+parse_statement_list(struct Context* context, struct ParseJobs* jobs);
+static struct AstNode*
+parse_statement(struct Context* context, struct ParseJobs* jobs);
 static struct AstNode* parse_block_statement(struct Context* context);
-static struct AstNode* parse_function_def(struct Context* context);
+static struct AstNode*
+parse_function_def(struct Context* context, struct ParseJobs* jobs);
+static struct AstNode*
+parse_body_deferred(struct Context* context, struct ParseJobs* jobs);
 static struct AstNode* parse_function_header(struct Context* context);
 static struct AstNode* parse_body(struct Context* context);
 static struct AstNode* parse_args(struct Context* context);
@@ -39,8 +53,9 @@ syntax_error(struct Context* context, struct lexer_token* t) {
   ERROR_ON_LINE(
       context,
       LT_lineno(t),
-      "syntax error on token {%ls, '%s'}\n",
+      "syntax error on token {%ls, '%.*ls'}\n",
       tokentype_to_string(LT_type(t)),
+      LT_lexeme_len(t),
       LT_lexeme(t));
 }
 static struct lexer_token*
@@ -57,30 +72,38 @@ static void add_location_for_token(
   Context_build_location(context, ast, LT_lineno(t), LT_lineno(t));
 }
 
+static int is_statement_start(struct lexer_token* t) {
+  return LT_type(t) == tt_FUNC || LT_type(t) == tt_EXTERN ||
+         LT_type(t) == tt_EXPORT || LT_type(t) == tt_TYPE ||
+         LT_type(t) == tt_LET || LT_type(t) == tt_ID || LT_type(t) == tt_STAR ||
+         LT_type(t) == tt_IF || LT_type(t) == tt_WHILE ||
+         LT_type(t) == tt_RETURN || LT_type(t) == tt_BREAK;
+}
+
 // statement_list -> EPSILON | statement | statement statement_list
-static struct AstNode* parse_statement_list(struct Context* context) {
-  struct lexer_token* t = lexer_peek(context, 1);
-  if(LT_type(t) == tt_FUNC || LT_type(t) == tt_EXTERN ||
-     LT_type(t) == tt_EXPORT || LT_type(t) == tt_TYPE || LT_type(t) == tt_LET ||
-     LT_type(t) == tt_ID || LT_type(t) == tt_STAR || LT_type(t) == tt_IF ||
-     LT_type(t) == tt_WHILE || LT_type(t) == tt_RETURN ||
-     LT_type(t) == tt_BREAK) {
-    struct AstNode* head = parse_statement(context);
-    struct AstNode* tail = parse_statement_list(context);
-    ast_append(&head, tail);
-    return head;
-  } else if(LT_type(t) == tt_ERROR) {
+// lists are parsed iteratively, keeping a tail pointer to append in O(1).
+// with `jobs`, function bodies are handed off to be parsed in parallel
+static struct AstNode*
+parse_statement_list(struct Context* context, struct ParseJobs* jobs) {
+  struct AstNode* head = NULL;
+  struct AstNode* tail = NULL;
+  struct lexer_token* t;
+  while(is_statement_start(t = lexer_peek(context, 1))) {
+    LL_APPEND_TAIL(head, tail, parse_statement(context, jobs));
+  }
+  if(LT_type(t) == tt_ERROR) {
     syntax_error(context, t);
   }
-  return NULL;
+  return head;
 }
 // statement -> function_def | type_def | var_def |
 // block_statement
-static struct AstNode* parse_statement(struct Context* context) {
+static struct AstNode*
+parse_statement(struct Context* context, struct ParseJobs* jobs) {
   struct lexer_token* t = lexer_peek(context, 1);
   if(LT_type(t) == tt_FUNC || LT_type(t) == tt_EXPORT ||
      LT_type(t) == tt_EXTERN) {
-    return parse_function_def(context);
+    return parse_function_def(context, jobs);
   } else if(LT_type(t) == tt_TYPE) {
     return parse_type_def(context);
   } else if(LT_type(t) == tt_LET) {
@@ -110,7 +133,8 @@ static struct AstNode* parse_block_statement(struct Context* context) {
   }
 }
 // function_def -> (EXTERN|EXPORT)? function_header (body|SEMICOLON)
-static struct AstNode* parse_function_def(struct Context* context) {
+static struct AstNode*
+parse_function_def(struct Context* context, struct ParseJobs* jobs) {
   // cxan only be extern or export
   int is_extern = 0;
   int is_export = 0;
@@ -138,7 +162,7 @@ static struct AstNode* parse_function_def(struct Context* context) {
           header,
           "cannot declare a extern function with a body");
     }
-    body = parse_body(context);
+    body = jobs ? parse_body_deferred(context, jobs) : parse_body(context);
   }
   // body can be null
   struct AstNode* func = ast_build_Function(header, body);
@@ -166,24 +190,20 @@ static struct AstNode* parse_function_header(struct Context* context) {
 // body -> LCURLY statement_list RCURLY
 static struct AstNode* parse_body(struct Context* context) {
   expect(context, tt_LCURLY);
-  struct AstNode* body = parse_statement_list(context);
+  struct AstNode* body = parse_statement_list(context, NULL);
   expect(context, tt_RCURLY);
   return ast_build_Block(body);
 }
 // args -> EPSILON | name_with_type | name_with_type COMMA args
 static struct AstNode* parse_args(struct Context* context) {
-  struct lexer_token* t = lexer_peek(context, 1);
-  if(LT_type(t) == tt_ID) {
-    struct AstNode* head = parse_name_with_type(context);
-    t = lexer_peek(context, 1);
-    if(LT_type(t) == tt_COMMA) {
-      expect(context, tt_COMMA);
-      struct AstNode* tail = parse_args(context);
-      ast_append(&head, tail);
-    }
-    return head;
+  struct AstNode* head = NULL;
+  struct AstNode* tail = NULL;
+  while(LT_type(lexer_peek(context, 1)) == tt_ID) {
+    LL_APPEND_TAIL(head, tail, parse_name_with_type(context));
+    if(LT_type(lexer_peek(context, 1)) != tt_COMMA) break;
+    expect(context, tt_COMMA);
   }
-  return NULL;
+  return head;
 }
 // name_with_type -> varname COLON typename
 static struct AstNode* parse_name_with_type(struct Context* context) {
@@ -225,15 +245,13 @@ static struct AstNode* parse_type_def(struct Context* context) {
 }
 // type_list -> EPSILON | name_with_type SEMICOLON type_list
 static struct AstNode* parse_type_list(struct Context* context) {
-  struct lexer_token* t = lexer_peek(context, 1);
-  if(LT_type(t) == tt_ID) {
-    struct AstNode* head = parse_name_with_type(context);
+  struct AstNode* head = NULL;
+  struct AstNode* tail = NULL;
+  while(LT_type(lexer_peek(context, 1)) == tt_ID) {
+    LL_APPEND_TAIL(head, tail, parse_name_with_type(context));
     expect(context, tt_SEMICOLON);
-    struct AstNode* tail = parse_type_list(context);
-    ast_append(&head, tail);
-    return head;
   }
-  return NULL;
+  return head;
 }
 // var_def -> LET varname (COLON typename)? (EQUALS expr)? SEMICOLON
 static struct AstNode* parse_var_def(struct Context* context) {
@@ -254,18 +272,26 @@ static struct AstNode* parse_var_def(struct Context* context) {
   add_location_for_token(context, var_node, t);
   return var_node;
 }
-// varname -> ID
-static struct AstNode* parse_varname(struct Context* context) {
-  struct lexer_token* t = expect(context, tt_ID);
+// interns the lexeme of an ID token
+static char* token_to_ident(struct lexer_token* t) {
   wchar_t* wname = LT_lexeme(t);
-  int len = wcslen(wname);
-  char* name = malloc(sizeof(*name) * (len + 1));
+  int len = LT_lexeme_len(t);
+  // most identifiers are short, so avoid the malloc
+  char buffer[64];
+  char* name = len < (int)sizeof(buffer) ? buffer : malloc(len + 1);
   for(int i = 0; i < len; i++) {
     ASSERT_MSG(wname[i] < 255, "only ascii idents");
     name[i] = (char)wname[i];
   }
   name[len] = '\0';
-  struct AstNode* ident = ast_build_Identifier(name);
+  char* interned = intern(name);
+  if(name != buffer) free(name);
+  return interned;
+}
+// varname -> ID
+static struct AstNode* parse_varname(struct Context* context) {
+  struct lexer_token* t = expect(context, tt_ID);
+  struct AstNode* ident = ast_build_Identifier(token_to_ident(t));
   add_location_for_token(context, ident, t);
   return ident;
 }
@@ -273,7 +299,7 @@ static struct AstNode* parse_varname(struct Context* context) {
 static struct AstNode* parse_typename(struct Context* context) {
   if(lexer_peek(context, 1)->tt == tt_TYPE) {
     struct lexer_token* t = expect(context, tt_TYPE);
-    struct AstNode* typename = ast_build_Typename("type");
+    struct AstNode* typename = ast_build_Typename(intern("type"));
     add_location_for_token(context, typename, t);
     return typename;
   } else {
@@ -283,49 +309,198 @@ static struct AstNode* parse_typename(struct Context* context) {
       expect(context, tt_STAR);
       ptr_level++;
     }
-    wchar_t* wname = LT_lexeme(t);
-    int len = wcslen(wname);
-    char* name = malloc(sizeof(*name) * (len + 1));
-    for(int i = 0; i < len; i++) {
-      ASSERT_MSG(wname[i] < 255, "only ascii idents");
-      name[i] = (char)wname[i];
-    }
-    name[len] = '\0';
-    struct AstNode* typename = ast_build_Typename2(name, ptr_level);
+    struct AstNode* typename =
+        ast_build_Typename2(token_to_ident(t), ptr_level);
     add_location_for_token(context, typename, t);
     return typename;
   }
 }
-// expr -> atom | atom op atom | preop atom
-static struct AstNode* parse_expr(struct Context* context) {
-  struct lexer_token* t = lexer_peek(context, 1);
-  if(LT_type(t) == tt_AMPERSAND || LT_type(t) == tt_STAR ||
-     LT_type(t) == tt_NOT || LT_type(t) == tt_MINUS) {
-    enum OperatorType op = parse_preop(context);
-    struct AstNode* lhs = parse_atom(context);
-    struct AstNode* expr_node = ast_build_Expr_uop(lhs, op);
-    add_location_for_token(context, expr_node, t);
-    return expr_node;
+// an operand on the expression stack, `start` is its first token
+struct ExprOperand {
+  struct AstNode* ast;
+  struct lexer_token* start;
+};
+// an operator on the expression stack, or the '(' that opened a group
+struct ExprOperator {
+  enum OperatorType op;
+  int precedence;
+  int is_unary;
+  int is_group;
+  struct lexer_token* tok;
+};
+// stacks start out on the C stack and only move to the heap for large exprs
+#define EXPR_STACK_INLINE 16
+struct ExprStack {
+  struct ExprOperand* operands;
+  int n_operands;
+  struct ExprOperator* operators;
+  int n_operators;
+  int capacity;
+  struct ExprOperand inline_operands[EXPR_STACK_INLINE];
+  struct ExprOperator inline_operators[EXPR_STACK_INLINE];
+};
+
+static void expr_stack_init(struct ExprStack* stack) {
+  stack->operands = stack->inline_operands;
+  stack->n_operands = 0;
+  stack->operators = stack->inline_operators;
+  stack->n_operators = 0;
+  stack->capacity = EXPR_STACK_INLINE;
+}
+static void expr_stack_deinit(struct ExprStack* stack) {
+  if(stack->operands != stack->inline_operands) free(stack->operands);
+  if(stack->operators != stack->inline_operators) free(stack->operators);
+}
+// both stacks share a capacity, neither can be larger than the token count
+static void expr_stack_reserve(struct ExprStack* stack) {
+  if(stack->n_operands < stack->capacity &&
+     stack->n_operators < stack->capacity)
+    return;
+  int capacity = stack->capacity * 2;
+  struct ExprOperand* operands = malloc(sizeof(*operands) * capacity);
+  struct ExprOperator* operators = malloc(sizeof(*operators) * capacity);
+  memcpy(operands, stack->operands, sizeof(*operands) * stack->n_operands);
+  memcpy(operators, stack->operators, sizeof(*operators) * stack->n_operators);
+  expr_stack_deinit(stack);
+  stack->operands = operands;
+  stack->operators = operators;
+  stack->capacity = capacity;
+}
+static void expr_push_operand(
+    struct ExprStack* stack,
+    struct AstNode* ast,
+    struct lexer_token* start) {
+  expr_stack_reserve(stack);
+  stack->operands[stack->n_operands++] =
+      (struct ExprOperand){.ast = ast, .start = start};
+}
+static void expr_push_operator(
+    struct ExprStack* stack,
+    enum OperatorType op,
+    int precedence,
+    int is_unary,
+    int is_group,
+    struct lexer_token* tok) {
+  expr_stack_reserve(stack);
+  stack->operators[stack->n_operators++] = (struct ExprOperator){
+      .op = op,
+      .precedence = precedence,
+      .is_unary = is_unary,
+      .is_group = is_group,
+      .tok = tok};
+}
+
+// higher binds tighter, 0 is not a binary operator
+static int binop_precedence(enum lexer_tokentype tt) {
+  switch(tt) {
+    case tt_OR: return 1;
+    case tt_AND: return 2;
+    case tt_EQ:
+    case tt_NEQ: return 3;
+    case tt_LT:
+    case tt_GT:
+    case tt_LTEQ:
+    case tt_GTEQ: return 4;
+    case tt_PLUS:
+    case tt_MINUS: return 5;
+    case tt_STAR:
+    case tt_DIVIDE: return 6;
+    case tt_COLON: return 7;
+    default: return 0;
+  }
+}
+// prefix operators bind tighter than any binary operator
+#define PREOP_PRECEDENCE 8
+
+// pops the top operator and applies it to the operands
+static void expr_reduce(struct Context* context, struct ExprStack* stack) {
+  struct ExprOperator op = stack->operators[--stack->n_operators];
+  if(op.is_unary) {
+    struct ExprOperand* operand = &stack->operands[stack->n_operands - 1];
+    struct AstNode* expr_node = ast_build_Expr_uop(operand->ast, op.op);
+    add_location_for_token(context, expr_node, op.tok);
+    operand->ast = expr_node;
+    operand->start = op.tok;
   } else {
-    struct lexer_token* tok_for_loc = t;
-    struct AstNode* lhs = parse_atom(context);
-    t = lexer_peek(context, 1);
-    if(LT_type(t) == tt_PLUS || LT_type(t) == tt_MINUS ||
-       LT_type(t) == tt_STAR || LT_type(t) == tt_DIVIDE ||
-       LT_type(t) == tt_AND || LT_type(t) == tt_OR || LT_type(t) == tt_LT ||
-       LT_type(t) == tt_GT || LT_type(t) == tt_LTEQ || LT_type(t) == tt_GTEQ ||
-       LT_type(t) == tt_EQ || LT_type(t) == tt_NEQ || LT_type(t) == tt_COLON) {
-      enum OperatorType op = parse_op(context);
-      struct AstNode* rhs = parse_atom(context);
-      struct AstNode* expr_node = ast_build_Expr_binop(lhs, rhs, op);
-      add_location_for_token(context, expr_node, tok_for_loc);
-      return expr_node;
-    } else {
-      struct AstNode* expr_node = ast_build_Expr_plain(lhs);
-      add_location_for_token(context, expr_node, tok_for_loc);
-      return expr_node;
+    struct ExprOperand rhs = stack->operands[--stack->n_operands];
+    struct ExprOperand* lhs = &stack->operands[stack->n_operands - 1];
+    struct AstNode* expr_node = ast_build_Expr_binop(lhs->ast, rhs.ast, op.op);
+    add_location_for_token(context, expr_node, lhs->start);
+    lhs->ast = expr_node;
+  }
+}
+// reduces operators that bind at least as tight as `precedence`, stopping at
+// the innermost open group
+static void expr_reduce_to(
+    struct Context* context,
+    struct ExprStack* stack,
+    int precedence) {
+  while(stack->n_operators > 0) {
+    struct ExprOperator* top = &stack->operators[stack->n_operators - 1];
+    if(top->is_group || top->precedence < precedence) break;
+    expr_reduce(context, stack);
+  }
+}
+
+// expr -> unary (op unary)*
+// unary -> preop* atom | preop* LPAREN expr RPAREN
+// binary operators are left associative and use the precedence of
+// binop_precedence. this uses an explicit stack rather than recursion, so long
+// operator chains and deeply nested parens do not grow the C stack. groups and
+// operators are not wrapped in an extra Expr, only a bare atom is
+static struct AstNode* parse_expr(struct Context* context) {
+  struct ExprStack stack;
+  expr_stack_init(&stack);
+  int open_groups = 0;
+  struct lexer_token* t;
+  while(1) {
+    // prefix operators and open parens
+    while(1) {
+      t = lexer_peek(context, 1);
+      if(LT_type(t) == tt_AMPERSAND || LT_type(t) == tt_STAR ||
+         LT_type(t) == tt_NOT || LT_type(t) == tt_MINUS) {
+        expr_push_operator(
+            &stack,
+            parse_preop(context),
+            PREOP_PRECEDENCE,
+            1,
+            0,
+            t);
+      } else if(LT_type(t) == tt_LPAREN) {
+        expect(context, tt_LPAREN);
+        expr_push_operator(&stack, op_NONE, 0, 0, 1, t);
+        open_groups++;
+      } else {
+        break;
+      }
     }
+    expr_push_operand(&stack, parse_atom(context), t);
+
+    // close any groups that end here
+    while(open_groups > 0 && LT_type(lexer_peek(context, 1)) == tt_RPAREN) {
+      expect(context, tt_RPAREN);
+      expr_reduce_to(context, &stack, 0);
+      // a group starts at its '('
+      struct ExprOperator group = stack.operators[--stack.n_operators];
+      stack.operands[stack.n_operands - 1].start = group.tok;
+      open_groups--;
+    }
+
+    t = lexer_peek(context, 1);
+    int precedence = binop_precedence(LT_type(t));
+    if(precedence == 0) break;
+    expr_reduce_to(context, &stack, precedence);
+    expr_push_operator(&stack, parse_op(context), precedence, 0, 0, t);
   }
+  if(open_groups > 0) syntax_error(context, t);
+  expr_reduce_to(context, &stack, 0);
+
+  struct ExprOperand result = stack.operands[0];
+  expr_stack_deinit(&stack);
+  if(ast_is_type(result.ast, ast_Expr)) return result.ast;
+  struct AstNode* expr_node = ast_build_Expr_plain(result.ast);
+  add_location_for_token(context, expr_node, result.start);
+  return expr_node;
 }
 
 static int is_literal(struct lexer_token* t) {
@@ -336,33 +511,42 @@ static int is_literal(struct lexer_token* t) {
 
 // expr_list -> EPSILON | expr | expr COMMA expr_list
 static struct AstNode* parse_expr_list(struct Context* context) {
-  struct lexer_token* t = lexer_peek(context, 1);
-  if(LT_type(t) == tt_AMPERSAND || LT_type(t) == tt_STAR ||
-     LT_type(t) == tt_NOT || LT_type(t) == tt_MINUS || is_literal(t) ||
-     LT_type(t) == tt_ID || LT_type(t) == tt_LPAREN) {
-    struct AstNode* head = parse_expr(context);
+  struct AstNode* head = NULL;
+  struct AstNode* tail = NULL;
+  struct lexer_token* t;
+  while(1) {
     t = lexer_peek(context, 1);
-    if(LT_type(t) == tt_COMMA) {
-      expect(context, tt_COMMA);
-      struct AstNode* tail = parse_expr_list(context);
-      ast_append(&head, tail);
-    }
-    return head;
+    if(!(LT_type(t) == tt_AMPERSAND || LT_type(t) == tt_STAR ||
+         LT_type(t) == tt_NOT || LT_type(t) == tt_MINUS || is_literal(t) ||
+         LT_type(t) == tt_ID || LT_type(t) == tt_LPAREN))
+      break;
+    LL_APPEND_TAIL(head, tail, parse_expr(context));
+    if(LT_type(lexer_peek(context, 1)) != tt_COMMA) break;
+    expect(context, tt_COMMA);
   }
-  return NULL;
+  return head;
 }
 // literal -> NUMBER | STRING_LITERAL | CHAR_LITERAL | TRUE | FALSE
 static struct AstNode* parse_literal(struct Context* context) {
   struct lexer_token* t = lexer_peek(context, 1);
   if(LT_type(t) == tt_NUMBER) {
     t = expect(context, tt_NUMBER);
-    struct AstNode* num_node =
-        ast_build_Number((int64_t)wcs_to_int(LT_lexeme(t)), 64);
+    long long value;
+    if(!wcsn_to_int(LT_lexeme(t), LT_lexeme_len(t), &value)) {
+      ERROR_ON_LINE(
+          context,
+          LT_lineno(t),
+          "integer literal too large '%.*ls'\n",
+          LT_lexeme_len(t),
+          LT_lexeme(t));
+    }
+    struct AstNode* num_node = ast_build_Number((int64_t)value, 64);
     add_location_for_token(context, num_node, t);
     return num_node;
   } else if(LT_type(t) == tt_STRING_LITERAL) {
     t = expect(context, tt_STRING_LITERAL);
-    struct AstNode* string_node = ast_build_String(LT_lexeme(t));
+    struct AstNode* string_node =
+        ast_build_String2(LT_lexeme(t), LT_lexeme_len(t));
     add_location_for_token(context, string_node, t);
     return string_node;
   } else if(LT_type(t) == tt_CHAR_LITERAL) {
@@ -390,8 +574,7 @@ static struct AstNode* parse_literal(struct Context* context) {
     syntax_error(context, t);
   }
 }
-// atom -> literal | varname | call_expr | varname (DOT|ARROW) varname | LPAREN
-// expr RPAREN
+// atom -> literal | varname | call_expr | varname (DOT|ARROW) varname
 static struct AstNode* parse_atom(struct Context* context) {
   struct lexer_token* t = lexer_peek(context, 1);
   if(is_literal(t)) {
@@ -415,13 +598,6 @@ static struct AstNode* parse_atom(struct Context* context) {
         return var;
       }
     }
-  } else if(LT_type(t) == tt_LPAREN) {
-    struct lexer_token* tok = expect(context, tt_LPAREN);
-    struct AstNode* expr = parse_expr(context);
-    expect(context, tt_RPAREN);
-    struct AstNode* wrapped_expr = ast_build_Expr_plain(expr);
-    add_location_for_token(context, wrapped_expr, tok);
-    return wrapped_expr;
   } else {
     syntax_error(context, t);
   }
@@ -573,9 +749,267 @@ static struct AstNode* parse_break_stmt(struct Context* context) {
   return break_node;
 }
 
+//
+// parallel parsing
+//
+// the main thread parses top level statements as usual, but instead of parsing
+// a function body it skips to the matching '}' and queues the body for the
+// thread pool. each job lexes its own view of the source with its own token
+// arena and records locations in its own table, which are merged at the end
+//
+// lazy parsing skips bodies the same way but queues them without a pool, then
+// only parses the bodies reachable from main and exported functions
+//
+
+// a function body handed off to a worker
+struct BodyJob {
+  // an empty block that the worker fills in, already linked into the AST
+  struct AstNode* block;
+  // source range of the body, from its '{' to just past its '}'
+  int start;
+  int end;
+  int line;
+  // position in source order
+  int index;
+  int done;
+  struct Context context;
+  struct ParseJobs* jobs;
+  struct BodyJob* next;
+  // lazy parsing only
+  struct AstNode* func;
+  int reached;
+  // the next lazy function with the same name
+  struct BodyJob* same_name;
+  struct BodyJob* next_work;
+};
+
+struct ParseJobs {
+  struct Context* context;
+  struct ThreadPool* pool;
+  mtx_t lock;
+  // signaled whenever more of the jobs in source order are done
+  cnd_t progress;
+  struct BodyJob* head;
+  struct BodyJob* tail;
+  // every job before this one is done
+  struct BodyJob* first_pending;
+  int n_jobs;
+  int n_done;
+  // lazy parsing only, maps a body block to its job
+  struct HashMap lazy_bodies;
+  // maps a function name to its jobs
+  struct HashMap lazy_by_name;
+  // bodies reached but not yet parsed
+  struct BodyJob* worklist;
+};
+
+static void wait_for_jobs(struct ParseJobs* jobs, int n) {
+  mtx_lock(&jobs->lock);
+  while(jobs->n_done < n)
+    cnd_wait(&jobs->progress, &jobs->lock);
+  mtx_unlock(&jobs->lock);
+}
+// a worker only reports a diagnostic once all earlier bodies parsed cleanly
+static void body_job_diagnostic_gate(struct Context* context) {
+  struct BodyJob* job = context->diagnostic_gate_data;
+  wait_for_jobs(job->jobs, job->index);
+}
+// the main thread is always past every body queued so far
+static void main_diagnostic_gate(struct Context* context) {
+  struct ParseJobs* jobs = context->diagnostic_gate_data;
+  wait_for_jobs(jobs, jobs->n_jobs);
+}
+
+static void parse_body_job(void* arg) {
+  struct BodyJob* job = arg;
+  struct Context* context = &job->context;
+  struct Arena* prev_arena = ast_set_arena(&context->ast_arena);
+  lexer_init_view(
+      context,
+      job->jobs->context->lexer,
+      job->start,
+      job->end,
+      job->line);
+  expect(context, tt_LCURLY);
+  struct AstNode* stmts = parse_statement_list(context, NULL);
+  expect(context, tt_RCURLY);
+  // the pre-scan and the lexer must agree on where the body ends
+  expect(context, tt_EOF);
+  lexer_deinit(context);
+  ast_Block_set_stmts(job->block, stmts);
+  ast_set_arena(prev_arena);
+
+  struct ParseJobs* jobs = job->jobs;
+  mtx_lock(&jobs->lock);
+  job->done = 1;
+  while(jobs->first_pending && jobs->first_pending->done) {
+    jobs->first_pending = jobs->first_pending->next;
+    jobs->n_done++;
+  }
+  cnd_broadcast(&jobs->progress);
+  mtx_unlock(&jobs->lock);
+}
+
+static struct AstNode*
+parse_body_deferred(struct Context* context, struct ParseJobs* jobs) {
+  int start;
+  int line;
+  // fall back to parsing it here, which reports the error for an unmatched '{'
+  if(!lexer_skip_block(context, &start, &line)) return parse_body(context);
+
+  struct BodyJob* job = malloc(sizeof(*job));
+  memset(job, 0, sizeof(*job));
+  job->block = ast_build_EmptyBlock();
+  job->start = start;
+  job->end = context->lexer->position;
+  job->line = line;
+  job->index = jobs->n_jobs++;
+  job->jobs = jobs;
+  job->context = *context;
+  job->context.lexer = NULL;
+  HashMap_init_pointers(&job->context.locations);
+  // bodies are usually small, so start with a small arena
+  Arena_init(&job->context.ast_arena, 4096);
+  if(jobs->pool) {
+    job->context.diagnostic_gate = body_job_diagnostic_gate;
+    job->context.diagnostic_gate_data = job;
+  }
+
+  mtx_lock(&jobs->lock);
+  if(jobs->tail) jobs->tail->next = job;
+  else jobs->head = job;
+  jobs->tail = job;
+  if(!jobs->first_pending) jobs->first_pending = job;
+  mtx_unlock(&jobs->lock);
+
+  if(jobs->pool) ThreadPool_submit(jobs->pool, parse_body_job, job);
+  else HashMap_put(&jobs->lazy_bodies, job->block, job);
+  return job->block;
+}
+
+static void init_jobs(struct ParseJobs* jobs, struct Context* context) {
+  memset(jobs, 0, sizeof(*jobs));
+  jobs->context = context;
+  mtx_init(&jobs->lock, mtx_plain);
+  cnd_init(&jobs->progress);
+}
+// hand the locations and nodes each job built over to the main context
+static void deinit_jobs(struct ParseJobs* jobs) {
+  struct BodyJob* job = jobs->head;
+  while(job) {
+    HashMap_merge(&jobs->context->locations, &job->context.locations);
+    HashMap_deinit(&job->context.locations);
+    Arena_adopt(&jobs->context->ast_arena, &job->context.ast_arena);
+    struct BodyJob* next = job->next;
+    free(job);
+    job = next;
+  }
+  cnd_destroy(&jobs->progress);
+  mtx_destroy(&jobs->lock);
+}
+
+static struct AstNode*
+parse_top_level_parallel(struct Context* context, int num_threads) {
+  struct ParseJobs jobs;
+  init_jobs(&jobs, context);
+  jobs.pool = ThreadPool_create(num_threads);
+  context->diagnostic_gate = main_diagnostic_gate;
+  context->diagnostic_gate_data = &jobs;
+
+  struct AstNode* stmts = parse_statement_list(context, &jobs);
+  ThreadPool_destroy(jobs.pool);
+
+  context->diagnostic_gate = NULL;
+  context->diagnostic_gate_data = NULL;
+  deinit_jobs(&jobs);
+  return stmts;
+}
+
+static void reach_function(struct ParseJobs* jobs, char* name) {
+  struct BodyJob* job = HashMap_get(&jobs->lazy_by_name, name);
+  for(; job; job = job->same_name) {
+    if(job->reached) continue;
+    job->reached = 1;
+    job->next_work = jobs->worklist;
+    jobs->worklist = job;
+  }
+}
+// any identifier may name a function, which over approximates but is cheap
+static void reach_identifiers(struct ParseJobs* jobs, struct AstNode* ast) {
+  for(; ast; ast = ast->next) {
+    if(ast_is_type(ast, ast_Identifier))
+      reach_function(jobs, ast_Identifier_name(ast));
+    ast_foreach_child(ast, child) { reach_identifiers(jobs, child); }
+  }
+}
+static struct BodyJob* lazy_job(struct ParseJobs* jobs, struct AstNode* ast) {
+  if(!ast_is_type(ast, ast_Function) || !ast_Function_has_body(ast))
+    return NULL;
+  return HashMap_get(&jobs->lazy_bodies, ast_Function_body(ast));
+}
+
+static struct AstNode* parse_top_level_lazy(struct Context* context) {
+  struct ParseJobs jobs;
+  init_jobs(&jobs, context);
+  HashMap_init_pointers(&jobs.lazy_bodies);
+  HashMap_init_strings(&jobs.lazy_by_name);
+
+  struct AstNode* stmts = parse_statement_list(context, &jobs);
+
+  char* main_name = intern("main");
+  int has_main = 0;
+  ast_foreach(stmts, s) {
+    struct BodyJob* job = lazy_job(&jobs, s);
+    if(!job) continue;
+    char* name = ast_Identifier_name(ast_Function_name(s));
+    job->func = s;
+    job->same_name = HashMap_get(&jobs.lazy_by_name, name);
+    HashMap_put(&jobs.lazy_by_name, name, job);
+    if(name == main_name) has_main = 1;
+  }
+  // without a main every function is externally visible, so all are roots
+  ast_foreach(stmts, s) {
+    struct BodyJob* job = lazy_job(&jobs, s);
+    if(!job) {
+      reach_identifiers(&jobs, s);
+      continue;
+    }
+    char* name = ast_Identifier_name(ast_Function_name(s));
+    if(!has_main || ast_Function_is_export(s) || name == main_name)
+      reach_function(&jobs, name);
+  }
+  while(jobs.worklist) {
+    struct BodyJob* job = jobs.worklist;
+    jobs.worklist = job->next_work;
+    parse_body_job(job);
+    reach_identifiers(&jobs, ast_Block_stmts(job->block));
+  }
+
+  // drop the functions that were never reached
+  struct AstNode** link = &stmts;
+  while(*link) {
+    struct BodyJob* job = lazy_job(&jobs, *link);
+    if(job && !job->reached) *link = (*link)->next;
+    else link = &(*link)->next;
+  }
+
+  HashMap_deinit(&jobs.lazy_bodies);
+  HashMap_deinit(&jobs.lazy_by_name);
+  deinit_jobs(&jobs);
+  return stmts;
+}
+
 void parser_init(__attribute__((unused)) struct Context* context) {}
 void parser_parse(struct Context* context) {
-  struct AstNode* body = parse_statement_list(context);
+  struct Arena* prev_arena = ast_set_arena(&context->ast_arena);
+  int num_threads = Arguments_numThreads(context->arguments);
+  struct AstNode* body;
+  if(Arguments_lazyBodies(context->arguments))
+    body = parse_top_level_lazy(context);
+  else if(num_threads > 1)
+    body = parse_top_level_parallel(context, num_threads);
+  else body = parse_statement_list(context, NULL);
   struct AstNode* block = ast_build_Block(body);
   context->ast = block;
+  ast_set_arena(prev_arena);
 }
@@ -0,0 +1,175 @@
+
+
+#include "ast/ast.h"
+#include "ast/scope-resolve.h"
+#include "context/arguments.h"
+#include "context/context.h"
+#include "parser/parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+
+enum Phase { LEX, PARSE, SCOPE };
+static const wchar_t* phase_names[] = {
+    L"lex",
+    L"lex+parse",
+    L"lex+parse+scope"};
+
+struct Counts {
+  long tokens;
+  long ast_nodes;
+};
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long file_size(char* filename) {
+  FILE* fp = fopen(filename, "rb");
+  if(fp == NULL) return 0;
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+static long count_ast_nodes(struct AstNode* ast) {
+  long count = 0;
+  LL_FOREACH(ast, a) {
+    count++;
+    for(int i = 0; i < ast_num_children(a); i++) {
+      struct AstNode* child = ast_get_child(a, i);
+      if(child) count += count_ast_nodes(child);
+    }
+  }
+  return count;
+}
+
+static long count_tokens(struct Context* context) {
+  long count = 0;
+  while(1) {
+    struct lexer_token* t = lexer_gettoken(context);
+    if(LT_type(t) == tt_EOF) break;
+    if(LT_type(t) == tt_ERROR) {
+      ERROR_ON_LINE(
+          context,
+          LT_lineno(t),
+          "invalid token '%.*ls'\n",
+          LT_lexeme_len(t),
+          LT_lexeme(t));
+    }
+    count++;
+  }
+  return count;
+}
+
+// runs a single iteration of `phase`, filling in whatever counts it can
+static void run_phase(
+    char* filename,
+    int threads,
+    int lazy,
+    enum Phase phase,
+    struct Counts* counts) {
+  struct Context context_;
+  struct Context* context = &context_;
+  struct Arguments* args = create_Arguments(filename, NULL, 0);
+  Arguments_setNumThreads(args, threads);
+  Arguments_setLazyBodies(args, lazy);
+  Context_init(context, args);
+  lexer_init(context);
+  if(phase == LEX) {
+    counts->tokens = count_tokens(context);
+    lexer_deinit(context);
+  } else {
+    parser_init(context);
+    parser_parse(context);
+    lexer_deinit(context);
+    if(phase == SCOPE) scope_resolve(context);
+    counts->ast_nodes = count_ast_nodes(context->ast);
+  }
+  // every iteration should start from the same heap
+  Context_deinit(context);
+  destroy_Arguments(args);
+}
+
+int main(int argc, char** argv) {
+
+  char* filename = NULL;
+  int iterations = 5;
+  int threads = 1;
+  int lazy = 0;
+
+  int i = 1;
+  while(i < argc) {
+    char* arg = argv[i];
+    if(arg[0] != '-') {
+      // if already have filename, warn
+      if(filename) {
+        fwprintf(
+            stderr,
+            L"Warning: multiple files specifed, ignore '%s'\n",
+            filename);
+      }
+      filename = arg;
+    } else if(strcmp(arg + 1, "iterations") == 0 && i + 1 < argc) {
+      i++;
+      iterations = atoi(argv[i]);
+    } else if(strcmp(arg + 1, "threads") == 0 && i + 1 < argc) {
+      i++;
+      threads = atoi(argv[i]);
+    } else if(strcmp(arg + 1, "lazy") == 0) {
+      lazy = 1;
+    } else {
+      fwprintf(stderr, L"Warning: unknown flag '%s'\n", arg);
+    }
+    i++;
+  }
+
+  if(filename == NULL || iterations < 1 || threads < 0) {
+    fwprintf(
+        stderr,
+        L"Error - usage: './pebl-bench-frontend <filename> (-iterations "
+        "N)? (-threads N)? (-lazy)?'\n");
+    return 1;
+  }
+
+  long bytes = file_size(filename);
+  // the lex phase gives the token count the other phases are measured by
+  struct Counts counts = {0};
+  for(enum Phase phase = LEX; phase <= SCOPE; phase++) {
+    // one untimed run to warm up caches and the allocator
+    run_phase(filename, threads, lazy, phase, &counts);
+
+    double best = 0;
+    for(int iter = 0; iter < iterations; iter++) {
+      double start = now();
+      run_phase(filename, threads, lazy, phase, &counts);
+      double elapsed = now() - start;
+      if(iter == 0 || elapsed < best) best = elapsed;
+    }
+
+    wprintf(
+        L"%-16ls %10.3f ms  %8.2f MB/sec  %12.0f tokens/sec",
+        phase_names[phase],
+        best * 1e3,
+        bytes / best / (1024 * 1024),
+        counts.tokens / best);
+    if(phase != LEX) {
+      wprintf(L"  %12.0f AST nodes/sec", counts.ast_nodes / best);
+    }
+    wprintf(L"\n");
+  }
+  wprintf(
+      L"%ld bytes, %ld tokens, %ld AST nodes (best of %d)\n",
+      bytes,
+      counts.tokens,
+      counts.ast_nodes,
+      iterations);
+
+  return 0;
+}
@@ -1,5 +1,4 @@
 #!/usr/bin/env python3
-import enum
 import os
 import sys
 import tempfile
@@ -22,8 +21,6 @@ import utils
 import paths
 import mp
 import arguments
-from shims import override
-import optimization
 
 
 @dataclass
@@ -62,27 +59,12 @@ class Executable:
             utils.error(f"'{' '.join(cmd)}' failed\n" + stdout if stdout else "")
 
 
-@dataclass
-class LLVMIrOptimizer(Executable):
-    passes: List[str] = field(default_factory=list)
-
-    @override
-    def get_cmd(self, *extra_args: str) -> List[str]:
-        cmd = super().get_cmd(*extra_args)
-        if len(self.passes) > 0:
-            pass_cmd = "-passes=" + ",".join(self.passes)
-            cmd.append(pass_cmd)
-        return cmd
-
-
 @dataclass
 class Toolchain:
     """a collection of programs to compile code"""
 
     # executables
     pebl_compiler: Optional[Executable] = None
-    llvm_ir_assembler: Optional[Executable] = None
-    llvm_ir_optimizer: Optional[Executable] = None
     linker: Optional[Executable] = None
     archiver: Optional[Executable] = None
 
@@ -96,61 +78,24 @@ class Libraries:
     startup: str
 
 
-class StopAfter(enum.Enum):
-    COMPILE = enum.auto()
-    OPTIMIZE = enum.auto()
-
-
 def build_file(
     file: str,
     toolchain: Toolchain,
     temp_dir: TempDirectory,
-    stop_after: Optional[StopAfter] = None,
+    human_readable: bool = False,
     outfile: Optional[str] = None,
 ) -> str:
-    assert (
-        toolchain.pebl_compiler != None
-        and toolchain.llvm_ir_optimizer != None
-        and toolchain.llvm_ir_assembler != None
-    )
-    assert toolchain.linker != None
+    assert toolchain.pebl_compiler != None
 
     basename = paths.getpathbase(os.path.basename(file))
 
-    # compile file to ir
-    ifile = file
-    should_stop_after = stop_after == StopAfter.COMPILE
-    ofile = (
-        outfile
-        if should_stop_after and outfile
-        else temp_dir.get_file(basename, suffix=".ll")
-    )
-    toolchain.pebl_compiler.execute(ifile, "-output", ofile)
-    if should_stop_after:
-        return ofile
-
-    # optimize ir
-    ifile = ofile
-    should_stop_after = stop_after == StopAfter.OPTIMIZE
-    ofile = (
-        outfile
-        if should_stop_after and outfile
-        else temp_dir.get_file(basename, suffix="-opt.ll")
-    )
-    toolchain.llvm_ir_optimizer.execute(ifile, "-o", ofile, "-S")
-    if should_stop_after:
-        return ofile
-
-    # assemble ir to obj
-    ifile = ofile
-    ofile = outfile if outfile else temp_dir.get_file(basename, suffix=".o")
-    toolchain.llvm_ir_assembler.execute(
-        ifile,
-        "-o",
-        ofile,
-        "-relocation-model=pic",
-        "-filetype=obj",
-    )
+    # peblc optimizes and emits in process
+    if human_readable:
+        ofile = outfile if outfile else temp_dir.get_file(basename, suffix=".ll")
+        toolchain.pebl_compiler.execute(file, "-emit=ll", "-output", ofile)
+    else:
+        ofile = outfile if outfile else temp_dir.get_file(basename, suffix=".o")
+        toolchain.pebl_compiler.execute(file, "-emit=obj", "-output", ofile)
     return ofile
 
 
@@ -204,13 +149,6 @@ def main(raw_args: List[str]) -> int:
     def get_llvm_names(name: str, LLVM_VERSION=17) -> List[str]:
         return [f"{name}-{LLVM_VERSION}", name]
 
-    def search_path_for_llvm(name: str) -> Optional[str]:
-        return paths.search_path(
-            name, search_names=get_llvm_names(name), extra_paths=args.paths
-        )
-
-    toolchain.llvm_ir_optimizer = wrap_executable("opt", search_path_for_llvm("opt"))
-    toolchain.llvm_ir_assembler = wrap_executable("llc", search_path_for_llvm("llc"))
     toolchain.archiver = wrap_executable(
         "ar",
         paths.search_path(
@@ -239,11 +177,8 @@ def main(raw_args: List[str]) -> int:
     if args.debug:
         toolchain.pebl_compiler.arguments.append("-g")
 
-    #
-    # build the opt pipeline
-    #
-    opt_path = toolchain.llvm_ir_optimizer.path
-    toolchain.llvm_ir_optimizer = LLVMIrOptimizer(opt_path, passes=args.opt.passes)
+    if len(args.opt.passes) > 0:
+        toolchain.pebl_compiler.arguments.append("-passes=" + ",".join(args.opt.passes))
 
     #
     # find the libraries
@@ -274,16 +209,8 @@ def main(raw_args: List[str]) -> int:
         temp_dir.makedirs()
 
     if args.compile:
-        stop_after = None
-        if args.human_readable:
-            stop_after = (
-                StopAfter.COMPILE
-                if args.opt == optimization.OptNone
-                else StopAfter.OPTIMIZE
-            )
-
         file = args.files[0]
-        build_file(file, toolchain, temp_dir, stop_after, args.output)
+        build_file(file, toolchain, temp_dir, args.human_readable, args.output)
     else:
         with mp.get_pool(args.jobs) as pool:
             build_executable(
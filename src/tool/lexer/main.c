@@ -6,8 +6,9 @@
 
 void print_token(struct lexer_token* t) {
   wprintf(
-      L"{%ls, lexeme='%ls'}\n",
+      L"{%ls, lexeme='%.*ls'}\n",
       tokentype_to_string(LT_type(t)),
+      LT_lexeme_len(t),
       LT_lexeme(t));
 }
 
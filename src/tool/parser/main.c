@@ -6,6 +6,7 @@
 #include "context/context.h"
 #include "parser/parser.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 
@@ -18,6 +19,8 @@ int main(int argc, char** argv) {
   int verify = 1;
   int checks = 1;
   int scope = 0;
+  int threads = 1;
+  int lazy = 0;
 
   int i = 1;
   while(i < argc) {
@@ -47,6 +50,11 @@ int main(int argc, char** argv) {
         checks = val_to_set;
       } else if(strcmp(flag, "scope") == 0) {
         scope = val_to_set;
+      } else if(strcmp(flag, "threads") == 0 && i + 1 < argc) {
+        i++;
+        threads = atoi(argv[i]);
+      } else if(strcmp(flag, "lazy") == 0) {
+        lazy = val_to_set;
       } else {
         fwprintf(stderr, L"Warning: unknown flag '%s'\n", arg);
       }
@@ -59,13 +67,15 @@ int main(int argc, char** argv) {
     fwprintf(
         stderr,
         L"Error - usage: './parser <filename> (-no-print)? (-verify)? "
-        "(-checks)?'\n");
+        "(-checks)? (-threads N)? (-lazy)?'\n");
     return 1;
   }
 
   struct Context context_;
   struct Context* context = &context_;
   struct Arguments* args = create_Arguments(filename, NULL, 0);
+  Arguments_setNumThreads(args, threads);
+  Arguments_setLazyBodies(args, lazy);
   Context_init(context, args);
   lexer_init(context);
   parser_init(context);
@@ -9,8 +9,49 @@
 #include "context/context.h"
 #include "parser/parser.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+// `-emit=KIND`, returns 0 if `kind` is not known
+static int parse_emit_kind(char* kind, enum EmitKind* emitKind) {
+  if(strcmp(kind, "ll") == 0) *emitKind = ek_LLVM_IR;
+  else if(strcmp(kind, "bc") == 0) *emitKind = ek_BITCODE;
+  else if(strcmp(kind, "asm") == 0) *emitKind = ek_ASSEMBLY;
+  else if(strcmp(kind, "obj") == 0) *emitKind = ek_OBJECT;
+  else return 0;
+  return 1;
+}
+
+// `-O0` to `-O3` and `-Os`, returns 0 for any other flag
+static int parse_opt_level(char* flag, char** passes) {
+  if(strcmp(flag, "O0") == 0) *passes = NULL;
+  else if(strcmp(flag, "O1") == 0) *passes = "default<O1>";
+  else if(strcmp(flag, "O2") == 0) *passes = "default<O2>";
+  else if(strcmp(flag, "O3") == 0) *passes = "default<O3>";
+  else if(strcmp(flag, "Os") == 0) *passes = "default<Os>";
+  else return 0;
+  return 1;
+}
+
+static char* emit_kind_suffix(enum EmitKind emitKind) {
+  switch(emitKind) {
+    case ek_LLVM_IR: return ".ll";
+    case ek_BITCODE: return ".bc";
+    case ek_ASSEMBLY: return ".s";
+    case ek_OBJECT: return ".o";
+  }
+  return ".ll";
+}
+
+static void print_usage() {
+  fwprintf(
+      stderr,
+      L"Error - usage: './peblc <filename> (-output FILENAME)? (-checks?) "
+      "-(verify)? (-g)? (-threads N)? (-lazy)? "
+      "(-emit=ll|bc|asm|obj)? (-O0|-O1|-O2|-O3|-Os|-passes=PASSES)? "
+      "(-time-passes)?'\n");
+}
+
 int main(int argc, char** argv) {
 
   char* filename = NULL;
@@ -18,6 +59,11 @@ int main(int argc, char** argv) {
   int checks = 1;
   char* outfile = NULL;
   int debug = 0;
+  int threads = 1;
+  int lazy = 0;
+  enum EmitKind emitKind = ek_LLVM_IR;
+  char* passes = NULL;
+  int timePasses = 0;
 
   int i = 1;
   while(i < argc) {
@@ -49,6 +95,26 @@ int main(int argc, char** argv) {
         outfile = argv[i];
       } else if(strcmp(flag, "g") == 0) {
         debug = val_to_set;
+      } else if(strcmp(flag, "threads") == 0) {
+        if(i + 1 >= argc) {
+          print_usage();
+          return 1;
+        }
+        i++;
+        threads = atoi(argv[i]);
+      } else if(strcmp(flag, "lazy") == 0) {
+        lazy = val_to_set;
+      } else if(strncmp(flag, "emit=", 5) == 0) {
+        if(!parse_emit_kind(flag + 5, &emitKind)) {
+          fwprintf(stderr, L"Error: unknown output kind '%s'\n", arg);
+          return 1;
+        }
+      } else if(parse_opt_level(flag, &passes)) {
+        // the level was stored in `passes`
+      } else if(strncmp(flag, "passes=", 7) == 0) {
+        passes = flag + 7;
+      } else if(strcmp(flag, "time-passes") == 0) {
+        timePasses = val_to_set;
       } else {
         fwprintf(stderr, L"Warning: unknown flag '%s'\n", arg);
       }
@@ -58,19 +124,21 @@ int main(int argc, char** argv) {
   }
 
   if(filename == NULL) {
-    fwprintf(
-        stderr,
-        L"Error - usage: './peblc <filename> (-output FILENAME)? (-checks?) "
-        "-(verify)? (-g)?'\n");
+    print_usage();
     return 1;
   }
   if(outfile == NULL) {
-    outfile = bsstrcat(filename, ".ll");
+    outfile = bsstrcat(filename, emit_kind_suffix(emitKind));
   }
 
   struct Context context_;
   struct Context* context = &context_;
   struct Arguments* args = create_Arguments(filename, outfile, debug);
+  Arguments_setNumThreads(args, threads);
+  Arguments_setLazyBodies(args, lazy);
+  Arguments_setEmitKind(args, emitKind);
+  Arguments_setPasses(args, passes);
+  Arguments_setTimePasses(args, timePasses);
   Context_init(context, args);
   lexer_init(context);
   parser_init(context);
@@ -17,12 +17,12 @@ class cAstNode(ctypes.Structure):
 
 cAstNodePtr = ctypes.POINTER(cAstNode)
 cAstNodePtrType = Type[cAstNodePtr]
+# only the header, the payload after it is sized by node type
 cAstNode._fields_ = [
     ("at", ctypes.c_int),
-    ("next", cAstNodePtr),
-    ("children", cAstNodePtr * 4),
     ("int_value", ctypes.c_int),
-    ("str_value", ctypes.c_char_p),
+    ("int_value2", ctypes.c_int),
+    ("next", cAstNodePtr),
 ]
 
 
@@ -35,7 +35,6 @@ cLocation._fields_ = [
     ("ast", cAstNodePtr),
     ("line_start", ctypes.c_int),
     ("line_end", ctypes.c_int),
-    ("next", cLocationPtr),
 ]
 
 
@@ -119,8 +118,8 @@ class AstNode:
                 p = None
 
     def children(self) -> Iterator["AstNode"]:
-        for c in self._instance.contents.children:
-            if c:
+        for i in range(clayer.lib.ast_num_children(self._instance)):
+            if c := clayer.lib.ast_get_child(self._instance, i):
                 yield AstNode.create(c, self)
 
     def parent(self) -> Optional["AstNode"]: